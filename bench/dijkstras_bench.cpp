@@ -0,0 +1,187 @@
+// Dijkstra benchmarks. Graph inputs are generated into the system temp directory.
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+
+#include "workloads.h"
+
+static void BM_LoadGraph_istream(benchmark::State& state) {
+    string file = graph_file(GraphShape::random, state.range(0), 8);
+    for (auto _ : state) {
+        Graph G;
+        file_to_graph(file, G);
+        benchmark::DoNotOptimize(G.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * 8);
+}
+BENCHMARK(BM_LoadGraph_istream)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+static void BM_LoadGraph_csr(benchmark::State& state) {
+    string file = graph_file(GraphShape::random, state.range(0), 8);
+    for (auto _ : state) {
+        CsrGraph G;
+        file_to_graph(file, G, state.range(1));
+        benchmark::DoNotOptimize(G.dst.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * 8);
+}
+BENCHMARK(BM_LoadGraph_csr)->ArgsProduct({{100000}, {1, 2, 4}})->UseRealTime()->Unit(benchmark::kMillisecond);
+
+template <typename GraphType>
+static void BM_Dijkstra(benchmark::State& state) {
+    GraphType G;
+    file_to_graph(graph_file(GraphShape::random, state.range(0), 8), G);
+    vector<int> previous;
+    for (auto _ : state)
+        benchmark::DoNotOptimize(dijkstra_shortest_path(G, 0, previous));
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK_TEMPLATE(BM_Dijkstra, Graph)->Arg(100000)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_Dijkstra, CsrGraph)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+// Every queue policy on sparse and dense graphs with small and large weights. The label
+// names the policy fastest_queue picks for that graph.
+static void BM_DijkstraQueue(benchmark::State& state) {
+    CsrGraph G;
+    file_to_graph(graph_file(GraphShape::random, state.range(0), state.range(1), state.range(2)), G);
+    DijkstraQueue queue = static_cast<DijkstraQueue>(state.range(3));
+    vector<int> previous;
+    for (auto _ : state)
+        benchmark::DoNotOptimize(dijkstra_shortest_path(G, 0, previous, queue));
+    state.SetItemsProcessed(state.iterations() * G.numEdges());
+    state.SetLabel(string(queue_name(queue)) + ", fastest: " + queue_name(fastest_queue(G)));
+}
+BENCHMARK(BM_DijkstraQueue)
+    ->ArgNames({"V", "deg", "maxw", "queue"})
+    ->ArgsProduct({{100000}, {4, 32}, {10, 10000}, {0, 1, 2, 3}})
+    ->Unit(benchmark::kMillisecond);
+
+// One source/target query answered by a full search, by the early-exit search and by ALT
+// with 8 landmarks (built once, outside the timed loop). Targets cycle through fixed pairs.
+static void BM_PointToPoint(benchmark::State& state) {
+    CsrGraph G;
+    file_to_graph(graph_file(GraphShape::random, state.range(0), 4), G);
+    AltLandmarks L = build_landmarks(G, 8);
+    mt19937 rng(1);
+    vector<pair<int, int>> pairs(64);
+    for (auto& [s, t] : pairs)
+        s = rng() % G.numVertices, t = rng() % G.numVertices;
+    vector<int> previous;
+    size_t i = 0;
+    for (auto _ : state) {
+        auto [s, t] = pairs[i++ % pairs.size()];
+        if (state.range(1) == 0)
+            benchmark::DoNotOptimize(dijkstra_shortest_path(G, s, previous));
+        else if (state.range(1) == 1)
+            benchmark::DoNotOptimize(dijkstra_point_to_point(G, s, t, previous));
+        else
+            benchmark::DoNotOptimize(alt_shortest_path(G, L, s, t, previous));
+    }
+    const char* names[] = {"full", "point_to_point", "alt"};
+    state.SetLabel(names[state.range(1)]);
+}
+BENCHMARK(BM_PointToPoint)->ArgNames({"V", "mode"})->ArgsProduct({{100000}, {0, 1, 2}})->Unit(benchmark::kMillisecond);
+
+// Distance rows from 64 sources: one dijkstra_shortest_path call per source versus the
+// many-source engine on 1 to 8 threads (range(1) == 0 is the loop of single calls).
+static void BM_MultiSource(benchmark::State& state) {
+    CsrGraph G;
+    file_to_graph(graph_file(GraphShape::random, state.range(0), 8), G);
+    vector<int> sources(64);
+    for (int i = 0; i < 64; i++)
+        sources[i] = i * (G.numVertices / 64);
+    vector<int> matrix(sources.size() * G.numVertices);
+    for (auto _ : state) {
+        if (state.range(1) == 0) {
+            vector<int> previous;
+            for (size_t i = 0; i < sources.size(); i++) {
+                vector<int> row = dijkstra_shortest_path<BinaryHeapQueue>(G, sources[i], previous);
+                copy(row.begin(), row.end(), matrix.begin() + i * G.numVertices);
+            }
+        } else {
+            multi_source_distances(G, sources, matrix, state.range(1));
+        }
+        benchmark::DoNotOptimize(matrix.data());
+    }
+    state.SetItemsProcessed(state.iterations() * sources.size());
+}
+BENCHMARK(BM_MultiSource)
+    ->ArgNames({"V", "threads"})
+    ->ArgsProduct({{100000}, {0, 1, 2, 4, 8}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+// Delta-stepping on a 1M-vertex random Graph at 1 to 8 threads, against the sequential
+// search (threads == 0 here). Real time is what shows the scaling.
+static void BM_DeltaStepping(benchmark::State& state) {
+    static Graph G;
+    if (G.numVertices != state.range(0))
+        file_to_graph(graph_file(GraphShape::random, state.range(0), 8), G);
+    vector<int> previous;
+    for (auto _ : state) {
+        if (state.range(1) == 0)
+            benchmark::DoNotOptimize(dijkstra_shortest_path<BinaryHeapQueue>(G, 0, previous));
+        else
+            benchmark::DoNotOptimize(delta_stepping_shortest_path(G, 0, previous, state.range(1)));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_DeltaStepping)
+    ->ArgNames({"V", "threads"})
+    ->ArgsProduct({{1000000}, {0, 1, 2, 4, 8}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+// Cost of keeping shortest paths current while single edge weights change: range(1) == 0
+// reruns dijkstra_shortest_path after every change, 1 repairs a DynamicShortestPaths.
+// The counter is the average number of vertices an incremental update touched.
+static void BM_DynamicUpdate(benchmark::State& state) {
+    Graph G;
+    file_to_graph(graph_file(GraphShape::random, state.range(0), 8), G);
+    DynamicShortestPaths paths(G, 0);
+    mt19937 rng(7);
+    vector<int> previous;
+    size_t touched = 0;
+    for (auto _ : state) {
+        int u = rng() % G.numVertices;
+        int dst = G[u][rng() % G[u].size()].dst;
+        int weight = 1 + rng() % 100;
+        if (state.range(1) == 0) {
+            // The same change set_weight makes: every edge u -> dst takes the new weight.
+            for (Edge& edge : G[u])
+                if (edge.dst == dst)
+                    edge.weight = weight;
+            benchmark::DoNotOptimize(dijkstra_shortest_path<BinaryHeapQueue>(G, 0, previous));
+        } else {
+            paths.set_weight(u, dst, weight);
+            touched += paths.last_update_size();
+        }
+    }
+    if (state.range(1) == 1)
+        state.counters["touched"] = double(touched) / state.iterations();
+    state.SetLabel(state.range(1) == 0 ? "recompute" : "incremental");
+}
+BENCHMARK(BM_DynamicUpdate)->ArgNames({"V", "mode"})->ArgsProduct({{100000}, {0, 1}})->Unit(benchmark::kMicrosecond);
+
+// Single-source queries on each generated graph family, one source per iteration, with
+// per-query latency percentiles, throughput, allocations per query and peak RSS.
+static void BM_DijkstraWorkload(benchmark::State& state) {
+    GraphShape shape = static_cast<GraphShape>(state.range(0));
+    Graph G;
+    file_to_graph(graph_file(shape, state.range(1)), G);
+    mt19937 rng(1);
+    vector<int> previous;
+    LatencyRecorder latency;
+    long allocations = allocation_count();
+    for (auto _ : state)
+        latency.time([&] { benchmark::DoNotOptimize(dijkstra_shortest_path(G, rng() % G.numVertices, previous)); });
+    latency.report(state);
+    report_resources(state, allocations, state.iterations());
+    state.SetItemsProcessed(state.iterations());
+    state.SetLabel(shape_name(shape));
+}
+BENCHMARK(BM_DijkstraWorkload)
+    ->ArgNames({"shape", "V"})
+    ->ArgsProduct({{0, 1, 2}, {10000, 100000}})
+    ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,172 @@
+// Word ladder benchmarks. Run from src/ so that words.txt is found, e.g.
+//   cd src && ../build/bench --benchmark_filter=WordLadder
+
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+
+#include "workloads.h"
+
+// The pairs checked by verify_word_ladder.
+static const vector<pair<string, string>> verify_pairs = {
+    {"cat", "dog"}, {"marty", "curls"}, {"code", "data"},
+    {"work", "play"}, {"sleep", "awake"}, {"car", "cheat"},
+};
+
+static void BM_WordLadder(benchmark::State& state, LadderMode mode) {
+    const WordGraph &graph = bench_graph();
+    const auto &[begin, end] = verify_pairs[state.range(0)];
+    LadderStats stats;
+    for (auto _ : state) {
+        stats = LadderStats();
+        benchmark::DoNotOptimize(generate_word_ladder(begin, end, graph, mode, &stats));
+    }
+    state.counters["expanded"] = stats.nodes_expanded;
+    state.SetLabel(begin + "->" + end);
+}
+BENCHMARK_CAPTURE(BM_WordLadder, forward, LadderMode::forward)->DenseRange(0, 5)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_WordLadder, bidirectional, LadderMode::bidirectional)->DenseRange(0, 5)->Unit(benchmark::kMicrosecond);
+
+// Queries sampled from words.txt, one per iteration: walk == 0 draws unrelated same-length
+// pairs (mostly unreachable), walk > 0 pairs each word with the end of a random walk.
+static void BM_LadderQueries(benchmark::State& state, LadderMode mode) {
+    const WordGraph &graph = bench_graph();
+    vector<pair<string, string>> queries = ladder_queries(500, state.range(0));
+    LadderWorkspace workspace;
+    LatencyRecorder latency;
+    size_t i = 0;
+    streambuf *saved = cerr.rdbuf(nullptr);   // silence "No word ladder found" for unreachable pairs
+    long allocations = allocation_count();
+    for (auto _ : state) {
+        const auto &[begin, end] = queries[i++ % queries.size()];
+        latency.time([&] { benchmark::DoNotOptimize(generate_word_ladder(begin, end, graph, workspace, mode)); });
+    }
+    cerr.rdbuf(saved);
+    cerr.clear();
+    latency.report(state);
+    report_resources(state, allocations, state.iterations());
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_CAPTURE(BM_LadderQueries, forward, LadderMode::forward)->ArgName("walk")->Arg(0)->Arg(3)->Arg(8)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_LadderQueries, bidirectional, LadderMode::bidirectional)->ArgName("walk")->Arg(0)->Arg(3)->Arg(8)->Unit(benchmark::kMicrosecond);
+
+// Repetitive traffic: 1000 sampled queries drawn from only 20 begin words. range(0) == 0
+// searches every query afresh; 1 answers from a LadderTreeCache large enough for all the trees.
+static void BM_LadderTreeCache(benchmark::State& state) {
+    const WordGraph &graph = bench_graph();
+    vector<pair<string, string>> seeds = ladder_queries(20, 6), queries;
+    vector<pair<string, string>> ends = ladder_queries(1000, 0, 2);
+    for (size_t i = 0; i < ends.size(); i++)
+        queries.emplace_back(seeds[i % seeds.size()].first, ends[i].second);
+    LadderWorkspace workspace;
+    streambuf *saved = cerr.rdbuf(nullptr);   // most sampled pairs have no ladder
+    for (auto _ : state) {
+        LadderTreeCache cache(graph, 64 << 20);
+        for (const auto &[begin, end] : queries)
+            benchmark::DoNotOptimize(state.range(0) == 0 ? generate_word_ladder(begin, end, graph, workspace)
+                                                         : cache.ladder(begin, end));
+    }
+    cerr.rdbuf(saved);
+    cerr.clear();
+    state.SetItemsProcessed(state.iterations() * queries.size());
+    state.SetLabel(state.range(0) == 0 ? "search" : "tree_cache");
+}
+BENCHMARK(BM_LadderTreeCache)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+// verify_word_ladder's pairs repeated into one batch, solved by a pool of state.range(0) threads.
+static void BM_LadderBatch(benchmark::State& state, LadderMode mode) {
+    vector<pair<string, string>> queries;
+    for (int copy = 0; copy < 50; copy++)
+        queries.insert(queries.end(), verify_pairs.begin(), verify_pairs.end());
+    LadderEngine engine(bench_graph(), state.range(0));
+    LadderBatchStats stats;
+    for (auto _ : state)
+        benchmark::DoNotOptimize(engine.solve(queries, mode, &stats));
+    state.counters["queries_per_second"] = stats.queries_per_second;
+    state.SetItemsProcessed(state.iterations() * queries.size());
+}
+BENCHMARK_CAPTURE(BM_LadderBatch, forward, LadderMode::forward)->RangeMultiplier(2)->Range(1, 8)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_LadderBatch, bidirectional, LadderMode::bidirectional)->RangeMultiplier(2)->Range(1, 8)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// Cold start: parse words.txt and build the index, versus mapping a compiled image.
+static void BM_DictionaryStartup_text(benchmark::State& state) {
+    for (auto _ : state) {
+        set<string> word_list;
+        load_words(word_list, "words.txt");
+        benchmark::DoNotOptimize(WordGraph(word_list).size());
+    }
+}
+BENCHMARK(BM_DictionaryStartup_text)->Unit(benchmark::kMillisecond);
+
+static void BM_DictionaryStartup_image(benchmark::State& state) {
+    string file = (filesystem::temp_directory_path() / "hw9_bench_words.idx").string();
+    save_word_graph(bench_graph(), file);
+    for (auto _ : state) {
+        WordGraph graph = load_word_graph(file);
+        benchmark::DoNotOptimize(graph.find("sleep"));
+    }
+    filesystem::remove(file);
+}
+BENCHMARK(BM_DictionaryStartup_image)->Unit(benchmark::kMicrosecond);
+
+// The edit_distance_within kernel before banding: a full (m+1)x(n+1) table per call.
+static bool full_table_edit_distance_within(const string& str1, const string& str2, int d) {
+    int m = str1.size();
+    int n = str2.size();
+    if (abs(m - n) > d) return false;
+    vector<vector<int>> dp(m + 1, vector<int>(n + 1, 0));
+    for (int i = 0; i <= m; i++) dp[i][0] = i;
+    for (int j = 0; j <= n; j++) dp[0][j] = j;
+    for (int i = 1; i <= m; i++) {
+        for (int j = 1; j <= n; j++) {
+            if (str1[i - 1] == str2[j - 1])
+                dp[i][j] = dp[i - 1][j - 1];
+            else
+                dp[i][j] = 1 + min({ dp[i - 1][j], dp[i][j - 1], dp[i - 1][j - 1] });
+        }
+        int row_min = *min_element(dp[i].begin(), dp[i].end());
+        if (row_min > d) return false;
+    }
+    return dp[m][n] <= d;
+}
+
+// The dictionary in sorted order; neighbouring entries are near misses sharing a prefix.
+static const vector<string>& sorted_words() {
+    static vector<string> words(bench_words().begin(), bench_words().end());
+    return words;
+}
+
+static void BM_EditDistance(benchmark::State& state, bool (*within)(const string&, const string&, int)) {
+    const vector<string> &words = sorted_words();
+    int d = state.range(0);
+    for (auto _ : state)
+        for (size_t i = 1; i < words.size(); i++)
+            benchmark::DoNotOptimize(within(words[i - 1], words[i], d));
+    state.SetItemsProcessed(state.iterations() * (words.size() - 1));
+}
+BENCHMARK_CAPTURE(BM_EditDistance, full_table, full_table_edit_distance_within)->Arg(1)->Arg(2)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_EditDistance, banded, edit_distance_within)->Arg(1)->Arg(2)->Unit(benchmark::kMillisecond);
+
+// One word against the whole dictionary, as a neighbor scan would do.
+static void BM_EditDistanceScan(benchmark::State& state, bool (*within)(const string&, const string&, int)) {
+    const vector<string> &words = sorted_words();
+    int d = state.range(0);
+    for (auto _ : state) {
+        int hits = 0;
+        for (const string &candidate : words)
+            hits += within("sleep", candidate, d);
+        benchmark::DoNotOptimize(hits);
+    }
+    state.SetItemsProcessed(state.iterations() * words.size());
+}
+BENCHMARK_CAPTURE(BM_EditDistanceScan, full_table, full_table_edit_distance_within)->Arg(1)->Arg(2)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_EditDistanceScan, banded, edit_distance_within)->Arg(1)->Arg(2)->Unit(benchmark::kMillisecond);
+
+static void BM_EditDistanceScan_bit_parallel(benchmark::State& state) {
+    const vector<string> &words = sorted_words();
+    int d = state.range(0);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(edit_distance_filter("sleep", words, d));
+    state.SetItemsProcessed(state.iterations() * words.size());
+}
+BENCHMARK(BM_EditDistanceScan_bit_parallel)->Arg(1)->Arg(2)->Unit(benchmark::kMillisecond);
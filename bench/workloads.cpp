@@ -0,0 +1,126 @@
+#include "workloads.h"
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+const char* shape_name(GraphShape shape) {
+    switch (shape) {
+    case GraphShape::random: return "random";
+    case GraphShape::grid: return "grid";
+    case GraphShape::power_law: return "power_law";
+    }
+    return "unknown";
+}
+
+void write_graph(ostream& out, GraphShape shape, int vertices, int degree, int max_weight, unsigned seed) {
+    mt19937 rng(seed);
+    auto edge = [&](int u, int v) { out << u << " " << v << " " << 1 + rng() % max_weight << "\n"; };
+    out << vertices << "\n";
+    switch (shape) {
+    case GraphShape::random:
+        for (int u = 0; u < vertices; u++)
+            for (int k = 0; k < degree; k++)
+                edge(u, rng() % vertices);
+        break;
+    case GraphShape::grid: {
+        int side = max(1, int(sqrt(double(vertices))));
+        for (int u = 0; u < vertices; u++) {
+            if ((u + 1) % side != 0 && u + 1 < vertices) {
+                edge(u, u + 1);
+                edge(u + 1, u);
+            }
+            if (u + side < vertices) {
+                edge(u, u + side);
+                edge(u + side, u);
+            }
+        }
+        break;
+    }
+    case GraphShape::power_law: {
+        int links = max(1, degree / 2);
+        vector<int> endpoints;   // every vertex once per incident edge
+        for (int v = 1; v < vertices; v++) {
+            size_t known = endpoints.size();
+            for (int k = 0; k < links; k++) {
+                int u = known == 0 ? 0 : endpoints[rng() % known];
+                edge(v, u);
+                edge(u, v);
+                endpoints.push_back(u);
+                endpoints.push_back(v);
+            }
+        }
+        break;
+    }
+    }
+}
+
+string graph_file(GraphShape shape, int vertices, int degree, int max_weight) {
+    string name = string("hw9_bench_") + shape_name(shape) + "_" + to_string(vertices) + "_" + to_string(degree) +
+                  "_" + to_string(max_weight) + ".txt";
+    string file = (filesystem::temp_directory_path() / name).string();
+    if (filesystem::exists(file))
+        return file;
+    string partial = file + ".partial";
+    {
+        ofstream out(partial);
+        write_graph(out, shape, vertices, degree, max_weight, vertices);
+    }
+    filesystem::rename(partial, file);
+    return file;
+}
+
+const set<string>& bench_words() {
+    static set<string> word_list = [] {
+        set<string> words;
+        load_words(words, "words.txt");
+        return words;
+    }();
+    return word_list;
+}
+
+const WordGraph& bench_graph() {
+    static WordGraph graph(bench_words());
+    return graph;
+}
+
+vector<pair<string, string>> ladder_queries(size_t count, int walk, unsigned seed) {
+    const WordGraph &graph = bench_graph();
+    mt19937 rng(seed);
+    vector<pair<string, string>> queries;
+    while (queries.size() < count) {
+        int begin = rng() % graph.size(), end = begin;
+        if (walk > 0) {
+            for (int step = 0; step < walk && !graph.neighbors(end).empty(); step++)
+                end = graph.neighbors(end)[rng() % graph.neighbors(end).size()];
+        } else {
+            span<const int> same_length = graph.words_of_length(graph.word(begin).size());
+            end = same_length[rng() % same_length.size()];
+        }
+        if (end != begin)
+            queries.emplace_back(string(graph.word(begin)), string(graph.word(end)));
+    }
+    return queries;
+}
+
+void LatencyRecorder::report(benchmark::State& state) {
+    if (samples.empty())
+        return;
+    sort(samples.begin(), samples.end());
+    auto percentile = [&](double p) { return samples[min(samples.size() - 1, size_t(p * samples.size()))]; };
+    state.counters["p50_us"] = percentile(0.50);
+    state.counters["p90_us"] = percentile(0.90);
+    state.counters["p99_us"] = percentile(0.99);
+    samples.clear();
+}
+
+void report_resources(benchmark::State& state, long allocations_before, double operations) {
+    state.counters["allocs_per_op"] = (allocation_count() - allocations_before) / max(1.0, operations);
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    state.counters["peak_rss_mib"] = usage.ru_maxrss / 1024.0;   // ru_maxrss is in KiB on Linux
+}
@@ -0,0 +1,60 @@
+// Synthetic inputs and reporting helpers shared by the benchmarks.
+
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "alloc_counter.h"
+#include "dijkstras.h"
+#include "ladder.h"
+
+using namespace std;
+
+// Graph families for the Dijkstra benchmarks:
+//   random     every vertex gets `degree` edges to uniformly random vertices
+//   grid       a square lattice, each cell linked both ways to its right and lower neighbors
+//   power_law  preferential attachment: each new vertex links both ways to degree / 2
+//              earlier vertices picked in proportion to their degree, so a few hubs emerge
+enum class GraphShape { random, grid, power_law };
+const char* shape_name(GraphShape shape);
+
+// Writes a graph in the file_to_graph format, weights uniform in [1, max_weight].
+void write_graph(ostream& out, GraphShape shape, int vertices, int degree, int max_weight, unsigned seed);
+// The same graph as a file in the system temp directory, generated on first use and reused
+// after that. The seed is the vertex count, so a given configuration is always the same graph.
+string graph_file(GraphShape shape, int vertices, int degree = 8, int max_weight = 100);
+
+// Words from src/words.txt and the WordGraph over them, loaded once.
+const set<string>& bench_words();
+const WordGraph& bench_graph();
+
+// count begin/end pairs drawn from the dictionary. With walk > 0 the end word is a random
+// walk of that many steps from the begin word, so a ladder exists; with walk == 0 it is any
+// word of the same length, which usually has no ladder and makes the search exhaust.
+vector<pair<string, string>> ladder_queries(size_t count, int walk, unsigned seed = 1);
+
+// Times individual operations inside a benchmark loop and reports their latency percentiles
+// (p50/p90/p99, in microseconds) as counters next to the usual mean.
+class LatencyRecorder {
+public:
+    template <typename F>
+    void time(F&& operation) {
+        auto start = chrono::steady_clock::now();
+        operation();
+        samples.push_back(chrono::duration<double, micro>(chrono::steady_clock::now() - start).count());
+    }
+    void report(benchmark::State& state);
+
+private:
+    vector<double> samples;
+};
+
+// Adds allocations per operation (allocation_count() deltas since `allocations_before`) and
+// the process's peak resident set size in MiB to the benchmark's counters.
+void report_resources(benchmark::State& state, long allocations_before, double operations);
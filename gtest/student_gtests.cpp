@@ -1,8 +1,823 @@
 #include <gtest/gtest.h>
 
+#include <filesystem>
+#include <random>
+
+#include "alloc_counter.h"
 #include "dijkstras.h"
 #include "ladder.h"
+#include "search_trace.h"
+
+template <typename F>
+static long allocations_during(F&& f) {
+  long before = allocation_count();
+  f();
+  return allocation_count() - before;
+}
+
+static const set<string>& dictionary() {
+  static set<string> word_list = [] {
+    set<string> words;
+    load_words(words, "words.txt");
+    return words;
+  }();
+  return word_list;
+}
+
+static const WordGraph& dictionary_graph() {
+  static WordGraph graph(dictionary());
+  return graph;
+}
+
+static int reference_edit_distance(const string& a, const string& b) {
+  vector<vector<int>> dp(a.size() + 1, vector<int>(b.size() + 1));
+  for (size_t i = 0; i <= a.size(); i++) dp[i][0] = i;
+  for (size_t j = 0; j <= b.size(); j++) dp[0][j] = j;
+  for (size_t i = 1; i <= a.size(); i++)
+    for (size_t j = 1; j <= b.size(); j++)
+      dp[i][j] = min({dp[i - 1][j] + 1, dp[i][j - 1] + 1, dp[i - 1][j - 1] + (a[i - 1] != b[j - 1])});
+  return dp[a.size()][b.size()];
+}
+
+static vector<string> random_words(int count, int max_length, unsigned seed) {
+  mt19937 rng(seed);
+  vector<string> words;
+  for (int w = 0; w < count; w++) {
+    string word(rng() % (max_length + 1), 'a');
+    for (char &c : word) c = 'a' + rng() % 3;
+    words.push_back(word);
+  }
+  return words;
+}
+
+TEST(EditDistance, MatchesFullTable) {
+  vector<string> words = random_words(120, 9, 46);
+  for (const string &a : words)
+    for (const string &b : words)
+      for (int d = 0; d <= 4; d++)
+        ASSERT_EQ(edit_distance_within(a, b, d), reference_edit_distance(a, b) <= d)
+            << a << " " << b << " " << d;
+}
+
+TEST(EditDistance, WideBandsAndLongWords) {
+  string a(150, 'a'), b(150, 'b');
+  EXPECT_TRUE(edit_distance_within(a, b, 150));
+  EXPECT_FALSE(edit_distance_within(a, b, 149));
+  EXPECT_TRUE(edit_distance_within(a, a + "b", 100));
+  EXPECT_TRUE(is_adjacent("chat", "cheat"));
+  EXPECT_TRUE(is_adjacent("cat", "cat"));
+  EXPECT_FALSE(is_adjacent("cat", "dog"));
+}
+
+TEST(EditDistance, FilterMatchesPairwise) {
+  vector<string> words = random_words(300, 12, 9);
+  words.push_back(string(64, 'a'));
+  words.push_back(string(70, 'a'));
+  for (int d = 0; d <= 3; d++)
+    for (size_t w = 0; w < words.size(); w += 7) {
+      vector<int> expected;
+      for (size_t c = 0; c < words.size(); c++)
+        if (reference_edit_distance(words[w], words[c]) <= d) expected.push_back(c);
+      ASSERT_EQ(edit_distance_filter(words[w], words, d), expected) << words[w] << " " << d;
+    }
+}
+
+TEST(WordGraph, IdsFollowSortedOrder) {
+  WordGraph graph(set<string>{"cat", "bat", "at", "cart"});
+  ASSERT_EQ(graph.size(), 4);
+  EXPECT_EQ(graph.word(0), "at");
+  EXPECT_EQ(graph.word(3), "cat");
+  EXPECT_EQ(graph.find("cart"), 2);
+  EXPECT_EQ(graph.find("dog"), -1);
+}
+
+TEST(WordGraph, NeighborsMatchOneEdit) {
+  WordGraph graph(set<string>{"at", "bat", "cart", "cat", "dog"});
+  auto ids = [&](const string& w) {
+    vector<string> words;
+    for (int id : graph.neighbors_of(w))
+      words.emplace_back(graph.word(id));
+    return words;
+  };
+  EXPECT_EQ(ids("cat"), (vector<string>{"at", "bat", "cart"}));
+  EXPECT_EQ(ids("at"), (vector<string>{"bat", "cat"}));
+  EXPECT_TRUE(ids("dog").empty());
+  EXPECT_EQ(ids("hat"), (vector<string>{"at", "bat", "cat"}));
+}
+
+TEST(WordGraph, InsertionsUseLettersOnly) {
+  // get_neighbors can delete the apostrophe but never insert one.
+  WordGraph graph(set<string>{"its", "it's"});
+  EXPECT_EQ(graph.neighbors(graph.find("it's")).size(), 1u);
+  EXPECT_TRUE(graph.neighbors(graph.find("its")).empty());
+}
+
+TEST(WordGraph, LengthPartition) {
+  WordGraph graph(set<string>{"at", "bat", "cart", "cat", "dog", "a"});
+  auto words = [&](size_t length) {
+    vector<string> out;
+    for (int id : graph.words_of_length(length))
+      out.emplace_back(graph.word(id));
+    return out;
+  };
+  EXPECT_EQ(words(1), (vector<string>{"a"}));
+  EXPECT_EQ(words(3), (vector<string>{"bat", "cat", "dog"}));
+  EXPECT_TRUE(words(0).empty());
+  EXPECT_TRUE(words(9).empty());
+}
+
+TEST(WordGraph, ImageRoundTrip) {
+  string file = (filesystem::temp_directory_path() / "hw9_words_test.idx").string();
+  save_word_graph(dictionary_graph(), file);
+  WordGraph mapped = load_word_graph(file);
+  filesystem::remove(file);
+
+  const WordGraph& built = dictionary_graph();
+  ASSERT_EQ(mapped.size(), built.size());
+  EXPECT_TRUE(equal(mapped.image.begin(), mapped.image.end(), built.image.begin(), built.image.end()));
+  EXPECT_EQ(mapped.find("sleep"), built.find("sleep"));
+  for (LadderMode mode : {LadderMode::forward, LadderMode::bidirectional})
+    EXPECT_EQ(generate_word_ladder("sleep", "awake", mapped, mode),
+              generate_word_ladder("sleep", "awake", built, mode));
+}
+
+TEST(WordGraph, RejectsBadImages) {
+  string file = (filesystem::temp_directory_path() / "hw9_bad_image.idx").string();
+  ofstream(file) << "not a word graph";
+  EXPECT_THROW(load_word_graph(file), runtime_error);
+  filesystem::remove(file);
+  EXPECT_THROW(load_word_graph(file), runtime_error);
+
+  // A max_length whose + 2 wraps in 32 bits must not slip past the size checks.
+  set<string> words = {"cat", "cot", "dog"};
+  save_word_graph(WordGraph(words), file);
+  string image;
+  {
+    ifstream in(file, ios::binary);
+    image.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+  }
+  auto damaged = [&](size_t offset, uint32_t value) {
+    string copy = image;
+    memcpy(&copy[offset], &value, sizeof(value));
+    ofstream(file, ios::binary) << copy;
+    return file;
+  };
+  // header: magic, version, words, arena, edges, max_length
+  EXPECT_THROW(load_word_graph(damaged(24, 0xFFFFFFFF)), runtime_error);
+
+  // Index arrays are checked too: word_offsets[4], length_offsets[5], by_length[3] and
+  // adj_offsets[4] follow the 32-byte header, then the first adjacency id.
+  EXPECT_THROW(load_word_graph(damaged(32 + 4 * 16, 0x3FFFFFFF)), runtime_error);
+  EXPECT_THROW(load_word_graph(damaged(32 + 4 * 1, 100)), runtime_error);   // word_offsets[1] past [2]
+  EXPECT_NO_THROW(load_word_graph(damaged(32 + 4 * 16, 1)));
+  filesystem::remove(file);
+}
+
+TEST(WordLadder, IndexMatchesSetSearch) {
+  const vector<pair<string, string>> pairs = {
+    {"cat", "dog"}, {"marty", "curls"}, {"code", "data"},
+    {"work", "play"}, {"car", "cheat"}, {"zzyzx", "cat"},
+  };
+  for (const auto &[begin, end] : pairs)
+    EXPECT_EQ(generate_word_ladder(begin, end, dictionary_graph()),
+              generate_word_ladder(begin, end, dictionary())) << begin << " -> " << end;
+  EXPECT_EQ(generate_word_ladder("sleep", "awake", dictionary_graph()).size(), 8u);
+}
+
+TEST(WordLadder, BidirectionalMatchesForward) {
+  const vector<pair<string, string>> pairs = {
+    {"cat", "dog"}, {"marty", "curls"}, {"code", "data"}, {"work", "play"},
+    {"sleep", "awake"}, {"car", "cheat"}, {"zzyzx", "cat"}, {"qqq", "cat"},
+    {"awake", "sleep"}, {"at", "its"}, {"stone", "money"},
+  };
+  for (const auto &[begin, end] : pairs) {
+    LadderStats forward, bidirectional;
+    EXPECT_EQ(generate_word_ladder(begin, end, dictionary_graph(), LadderMode::bidirectional, &bidirectional),
+              generate_word_ladder(begin, end, dictionary_graph(), LadderMode::forward, &forward))
+        << begin << " -> " << end;
+    EXPECT_GT(bidirectional.nodes_expanded, 0);
+  }
+}
+
+TEST(WordLadder, BidirectionalKeepsFirstLadderOnTies) {
+  // Two shortest ladders a -> {b, c} -> d; forward BFS reaches d through b first.
+  set<string> words = {"cat", "cot", "cog", "dog", "cag", "dot"};
+  WordGraph graph(words);
+  for (const auto &[begin, end] : vector<pair<string, string>>{{"cat", "dog"}, {"dog", "cat"}, {"hat", "dog"}})
+    EXPECT_EQ(generate_word_ladder(begin, end, graph, LadderMode::bidirectional),
+              generate_word_ladder(begin, end, words)) << begin << " -> " << end;
+}
+
+TEST(WordLadder, WorkspaceAllocationsDoNotScaleWithLength) {
+  const WordGraph& graph = dictionary_graph();
+  for (LadderMode mode : {LadderMode::forward, LadderMode::bidirectional}) {
+    LadderWorkspace workspace;
+    generate_word_ladder("cat", "dog", graph, workspace, mode);
+    long short_ladder = allocations_during([&] {
+      EXPECT_EQ(generate_word_ladder("cat", "dog", graph, workspace, mode).size(), 4u);
+    });
+    long long_ladder = allocations_during([&] {
+      EXPECT_EQ(generate_word_ladder("sleep", "awake", graph, workspace, mode).size(), 8u);
+    });
+    // Only the returned vector; every word fits in the small-string buffer.
+    EXPECT_EQ(short_ladder, 1);
+    EXPECT_EQ(long_ladder, 1);
+  }
+}
+
+TEST(WordLadder, SetSearchAllocationsDoNotScaleWithLength) {
+  // Each query partitions the dictionary by length; the search itself only adds its queue,
+  // two candidate buffers and the returned ladder, however many words it expands.
+  const set<string>& words = dictionary();
+  long partition = allocations_during([&] {
+    map<int, set<string_view>> by_length;
+    for (const string &word : words)
+      by_length[word.size()].insert(word);
+  });
+  long short_ladder = allocations_during([&] {
+    EXPECT_EQ(generate_word_ladder("cat", "dog", words).size(), 4u);
+  });
+  long long_ladder = allocations_during([&] {
+    EXPECT_EQ(generate_word_ladder("sleep", "awake", words).size(), 8u);
+  });
+  EXPECT_EQ(short_ladder - partition, 4);
+  EXPECT_EQ(long_ladder - partition, 4);
+}
+
+TEST(WordLadder, WorkspaceIsReusableAcrossQueries) {
+  LadderWorkspace workspace;
+  for (int round = 0; round < 2; round++)
+    for (LadderMode mode : {LadderMode::bidirectional, LadderMode::forward}) {
+      EXPECT_EQ(generate_word_ladder("work", "play", dictionary_graph(), workspace, mode),
+                generate_word_ladder("work", "play", dictionary()));
+      EXPECT_EQ(generate_word_ladder("qqq", "cat", dictionary_graph(), workspace, mode),
+                generate_word_ladder("qqq", "cat", dictionary()));
+    }
+}
+
+TEST(LadderEngine, BatchMatchesSequential) {
+  const WordGraph& graph = dictionary_graph();
+  vector<pair<string, string>> queries = {
+    {"cat", "dog"}, {"marty", "curls"}, {"code", "data"}, {"work", "play"}, {"sleep", "awake"},
+    {"car", "cheat"}, {"cat", "cat"}, {"qqq", "cat"}, {"cat", "notaword"}, {"awake", "sleep"},
+  };
+  for (int copy = 0; copy < 3; copy++)
+    queries.insert(queries.end(), queries.begin(), queries.begin() + 10);
+
+  for (LadderMode mode : {LadderMode::forward, LadderMode::bidirectional}) {
+    vector<vector<string>> expected;
+    for (const auto &[begin, end] : queries)
+      expected.push_back(generate_word_ladder(begin, end, graph, mode));
+    for (unsigned threads : {1u, 3u, 8u}) {
+      LadderEngine engine(graph, threads);
+      LadderBatchStats stats;
+      EXPECT_EQ(engine.solve(queries, mode, &stats), expected) << threads << " threads";
+      EXPECT_EQ(engine.solve(queries, mode), expected) << threads << " threads, second batch";
+      EXPECT_EQ(stats.queries, queries.size());
+      EXPECT_EQ(stats.threads, threads);
+      EXPECT_GT(stats.queries_per_second, 0);
+    }
+  }
+}
+
+TEST(LadderEngine, EmptyBatch) {
+  LadderEngine engine(dictionary_graph(), 4);
+  EXPECT_TRUE(engine.solve({}).empty());
+}
+
+TEST(WordLadder, SameWordHasNoLadder) {
+  EXPECT_TRUE(generate_word_ladder("cat", "cat", dictionary_graph()).empty());
+}
+
+static const vector<string> graph_files = {"small.txt", "medium.txt", "large.txt", "largest.txt"};
+
+TEST(CsrGraph, LoaderMatchesGraph) {
+  for (const string &file : graph_files) {
+    Graph G;
+    file_to_graph(file, G);
+    for (unsigned threads : {1u, 2u, 7u}) {
+      CsrGraph C;
+      file_to_graph(file, C, threads);
+      ASSERT_EQ(C.numVertices, G.numVertices) << file;
+      for (int u = 0; u < G.numVertices; u++) {
+        ASSERT_EQ(C.offsets[u + 1] - C.offsets[u], int(G[u].size())) << file << " " << u;
+        for (int k = C.offsets[u], i = 0; k < C.offsets[u + 1]; k++, i++) {
+          EXPECT_EQ(C.dst[k], G[u][i].dst);
+          EXPECT_EQ(C.weight[k], G[u][i].weight);
+        }
+      }
+    }
+  }
+}
+
+TEST(CsrGraph, DijkstraMatchesGraph) {
+  for (const string &file : graph_files) {
+    Graph G;
+    CsrGraph C;
+    file_to_graph(file, G);
+    file_to_graph(file, C, 3);
+    for (int source = 0; source < G.numVertices; source++) {
+      vector<int> previous_g, previous_c;
+      EXPECT_EQ(dijkstra_shortest_path(C, source, previous_c), dijkstra_shortest_path(G, source, previous_g));
+      EXPECT_EQ(previous_c, previous_g);
+    }
+  }
+}
+
+TEST(CsrGraph, ChunksSplitAnywhere) {
+  // Edges spread over lines unevenly, so chunk boundaries fall inside edges.
+  string file = (filesystem::temp_directory_path() / "hw9_csr_test.txt").string();
+  ofstream(file) << "  5\n0 1 7 0\n2 3\t1 2 1\n\n3 4 2 4 0 9 1 3\n 5\r\n2 4 1 ";
+  CsrGraph expected;
+  file_to_graph(file, expected, 1);
+  EXPECT_EQ(expected.numVertices, 5);
+  EXPECT_EQ(expected.offsets, (vector<int>{0, 2, 4, 5, 6, 7}));
+  EXPECT_EQ(expected.dst, (vector<int>{1, 2, 2, 3, 4, 4, 0}));
+  EXPECT_EQ(expected.weight, (vector<int>{7, 3, 1, 5, 1, 2, 9}));
+  for (unsigned threads = 2; threads <= 12; threads++) {
+    CsrGraph C;
+    file_to_graph(file, C, threads);
+    EXPECT_EQ(C.offsets, expected.offsets) << threads;
+    EXPECT_EQ(C.dst, expected.dst) << threads;
+    EXPECT_EQ(C.weight, expected.weight) << threads;
+  }
+  filesystem::remove(file);
+}
+
+TEST(CsrGraph, RejectsBadInput) {
+  string file = (filesystem::temp_directory_path() / "hw9_csr_bad.txt").string();
+  CsrGraph C;
+  ofstream(file) << "3\n0 1 x\n";
+  EXPECT_THROW(file_to_graph(file, C, 2), runtime_error);
+  ofstream(file) << "3\n0 5 1\n";
+  EXPECT_THROW(file_to_graph(file, C), runtime_error);
+  ofstream(file) << "3\n0 1 4\n1 2";   // truncated last edge
+  EXPECT_THROW(file_to_graph(file, C), runtime_error);
+  EXPECT_THROW(file_to_graph(file, C, 3), runtime_error);
+  ofstream(file) << "";
+  EXPECT_THROW(file_to_graph(file, C), runtime_error);
+  filesystem::remove(file);
+  EXPECT_THROW(file_to_graph(file, C), runtime_error);
+}
+
+static Graph random_graph(int vertices, int edges, int max_weight, unsigned seed) {
+  mt19937 rng(seed);
+  Graph G;
+  G.numVertices = vertices;
+  G.resize(vertices);
+  for (int e = 0; e < edges; e++) {
+    int u = rng() % vertices;
+    G[u].push_back(Edge(u, rng() % vertices, 1 + rng() % max_weight));
+  }
+  return G;
+}
+
+// The course graph files followed by the extra graphs.
+static vector<Graph> course_graphs(vector<Graph> extra) {
+  vector<Graph> graphs(graph_files.size());
+  for (size_t i = 0; i < graph_files.size(); i++)
+    file_to_graph(graph_files[i], graphs[i]);
+  graphs.insert(graphs.end(), make_move_iterator(extra.begin()), make_move_iterator(extra.end()));
+  return graphs;
+}
+
+static const DijkstraQueue all_queues[] = {DijkstraQueue::binary_heap, DijkstraQueue::dary_heap,
+                                           DijkstraQueue::radix_heap, DijkstraQueue::dial};
+
+TEST(DijkstraQueues, AllPoliciesAgree) {
+  vector<Graph> graphs = course_graphs({
+      random_graph(500, 3000, 3, 1),
+      random_graph(500, 3000, 1000, 2)
+  });
+  for (const Graph &G : graphs)
+    for (int source = 0; source < min(G.numVertices, 25); source++) {
+      vector<int> plain_previous, expected_previous;
+      vector<int> plain = dijkstra_shortest_path(G, source, plain_previous);
+      vector<int> expected = dijkstra_shortest_path<BinaryHeapQueue>(G, source, expected_previous);
+      EXPECT_EQ(expected, plain);
+      EXPECT_EQ(expected_previous, plain_previous);
+      for (DijkstraQueue queue : all_queues) {
+        vector<int> previous;
+        EXPECT_EQ(dijkstra_shortest_path(G, source, previous, queue), expected) << queue_name(queue);
+        EXPECT_EQ(previous, expected_previous) << queue_name(queue);
+      }
+    }
+}
+
+TEST(DijkstraQueues, PathsDoNotDependOnQueue) {
+  // A 20 x 20 grid of unit edges in both directions: most pairs have many shortest routes.
+  const int side = 20;
+  Graph G;
+  G.numVertices = side * side;
+  G.resize(G.numVertices);
+  for (int r = 0; r < side; r++)
+    for (int c = 0; c < side; c++) {
+      int u = r * side + c;
+      if (c + 1 < side) {
+        G[u].push_back(Edge(u, u + 1, 1));
+        G[u + 1].push_back(Edge(u + 1, u, 1));
+      }
+      if (r + 1 < side) {
+        G[u].push_back(Edge(u, u + side, 1));
+        G[u + side].push_back(Edge(u + side, u, 1));
+      }
+    }
+  for (int source : {0, side * side / 2 + side / 2, side * side - 1}) {
+    vector<int> plain_previous;
+    vector<int> plain = dijkstra_shortest_path(G, source, plain_previous);
+    for (DijkstraQueue queue : all_queues) {
+      vector<int> previous;
+      vector<int> distances = dijkstra_shortest_path(G, source, previous, queue);
+      for (int target = 0; target < G.numVertices; target++)
+        ASSERT_EQ(extract_shortest_path(distances, previous, target),
+                  extract_shortest_path(plain, plain_previous, target))
+            << queue_name(queue) << " " << source << " -> " << target;
+    }
+  }
+}
+
+TEST(DijkstraQueues, PreviousIsSmallestTightPredecessor) {
+  Graph G = random_graph(300, 2000, 4, 3);
+  vector<int> previous;
+  vector<int> distances = dijkstra_shortest_path<RadixHeapQueue>(G, 0, previous);
+  vector<int> smallest(G.numVertices, -1);
+  for (int u = 0; u < G.numVertices; u++)
+    for (const Edge &e : G[u])
+      if (distances[u] != INF && e.dst != 0 && distances[u] + e.weight == distances[e.dst] &&
+          (smallest[e.dst] == -1 || u < smallest[e.dst]))
+        smallest[e.dst] = u;
+  EXPECT_EQ(previous, smallest);
+}
+
+TEST(DijkstraQueues, DialGrowsForHeavyEdges) {
+  DialQueue queue(3);
+  queue.push(0, 0);
+  queue.push(1, 5000);
+  queue.push(2, 70);
+  EXPECT_EQ(queue.pop().vertex, 0);
+  EXPECT_EQ(queue.pop().vertex, 2);
+  Node last = queue.pop();
+  EXPECT_EQ(last.vertex, 1);
+  EXPECT_EQ(last.distance, 5000);
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(DijkstraQueues, IndexedHeapDecreasesKey) {
+  IndexedDaryHeapQueue<4> queue(4);
+  queue.push(1, 10);
+  queue.push(2, 5);
+  queue.push(1, 3);
+  queue.push(2, 8);
+  EXPECT_EQ(queue.pop().vertex, 1);
+  Node next = queue.pop();
+  EXPECT_EQ(next.vertex, 2);
+  EXPECT_EQ(next.distance, 5);
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(DijkstraQueues, DialSkippedForHugeWeights) {
+  Graph G = random_graph(50, 200, 10, 16);
+  G[0].push_back(Edge(0, 1, 1000000000));
+  EXPECT_NE(fastest_queue(G), DijkstraQueue::dial);
+  vector<int> expected_previous, previous;
+  vector<int> expected = dijkstra_shortest_path<BinaryHeapQueue>(G, 0, expected_previous);
+  EXPECT_EQ(dijkstra_shortest_path(G, 0, previous, DijkstraQueue::dial), expected);
+  EXPECT_EQ(previous, expected_previous);
+}
+
+static int path_length(const Graph &G, const vector<int> &path) {
+  int total = 0;
+  for (size_t i = 1; i < path.size(); i++) {
+    int best = INF;
+    for (const Edge &e : G[path[i - 1]])
+      if (e.dst == path[i])
+        best = min(best, e.weight);
+    if (best == INF)
+      return -1;
+    total += best;
+  }
+  return total;
+}
+
+TEST(PointToPoint, MatchesFullSearch) {
+  vector<Graph> graphs = course_graphs({random_graph(400, 1200, 5, 4)});
+  for (const Graph &G : graphs)
+    for (int source = 0; source < min(G.numVertices, 10); source++) {
+      vector<int> full_previous;
+      vector<int> full = dijkstra_shortest_path(G, source, full_previous);
+      for (int target = 0; target < G.numVertices; target++) {
+        vector<int> previous;
+        vector<int> distances = dijkstra_point_to_point(G, source, target, previous);
+        EXPECT_EQ(distances[target], full[target]);
+        EXPECT_EQ(extract_shortest_path(distances, previous, target),
+                  extract_shortest_path(full, full_previous, target));
+      }
+    }
+}
+
+TEST(PointToPoint, AltFindsShortestPaths) {
+  // The random graph is sparse enough to leave unreachable pairs.
+  vector<Graph> graphs = course_graphs({random_graph(400, 1000, 20, 5)});
+  for (const Graph &G : graphs) {
+    AltLandmarks L = build_landmarks(G, 4);
+    for (int source = 0; source < min(G.numVertices, 10); source++) {
+      vector<int> full_previous;
+      vector<int> full = dijkstra_shortest_path(G, source, full_previous);
+      for (int target = 0; target < G.numVertices; target++) {
+        EXPECT_LE(L.lower_bound(source, target), full[target]);
+        vector<int> previous;
+        vector<int> distances = alt_shortest_path(G, L, source, target, previous);
+        EXPECT_EQ(distances[target], full[target]);
+        if (full[target] != INF) {
+          vector<int> path = extract_shortest_path(distances, previous, target);
+          ASSERT_FALSE(path.empty());
+          EXPECT_EQ(path.front(), source);
+          EXPECT_EQ(path_length(G, path), full[target]);
+        }
+      }
+    }
+  }
+}
+
+TEST(MultiSource, MatrixMatchesSingleSource) {
+  vector<Graph> graphs = course_graphs({random_graph(300, 900, 50, 6)});
+  for (const Graph &G : graphs)
+    for (DijkstraQueue queue : all_queues) {
+      vector<int> matrix = all_pairs_distances(G, 3, queue);
+      ASSERT_EQ(matrix.size(), size_t(G.numVertices) * G.numVertices);
+      for (int source = 0; source < G.numVertices; source++) {
+        vector<int> previous;
+        vector<int> expected = dijkstra_shortest_path(G, source, previous);
+        EXPECT_TRUE(equal(expected.begin(), expected.end(), matrix.begin() + size_t(source) * G.numVertices))
+            << queue_name(queue) << " source " << source;
+      }
+    }
+}
+
+TEST(MultiSource, StreamedRowsMatchMatrix) {
+  Graph G = random_graph(200, 800, 20, 7);
+  CsrGraph C;
+  C.numVertices = G.numVertices;
+  C.offsets.assign(1, 0);
+  for (int u = 0; u < G.numVertices; u++) {
+    for (const Edge &e : G[u]) {
+      C.dst.push_back(e.dst);
+      C.weight.push_back(e.weight);
+    }
+    C.offsets.push_back(C.dst.size());
+  }
+  vector<int> sources = {5, 0, 199, 5, 42};
+  vector<int> matrix(sources.size() * G.numVertices);
+  multi_source_distances(G, sources, matrix, 2);
+
+  vector<vector<int>> rows(sources.size());
+  multi_source_distances(C, sources, [&](size_t i, span<const int> row) {
+    EXPECT_TRUE(rows[i].empty());
+    rows[i].assign(row.begin(), row.end());
+  }, 4);
+  for (size_t i = 0; i < sources.size(); i++)
+    EXPECT_TRUE(equal(rows[i].begin(), rows[i].end(), matrix.begin() + i * G.numVertices)) << i;
+
+  vector<int> too_small(G.numVertices);
+  EXPECT_THROW(multi_source_distances(G, sources, too_small), runtime_error);
+  EXPECT_THROW(multi_source_distances(G, vector<int>{200}, too_small), runtime_error);
+}
+
+TEST(DeltaStepping, MatchesSequential) {
+  vector<Graph> graphs = course_graphs({
+      random_graph(2000, 8000, 100, 8),
+      random_graph(2000, 3000, 7, 9)   // leaves unreachable vertices
+  });
+  for (const Graph &G : graphs)
+    for (int source : {0, G.numVertices / 2})
+      for (unsigned threads : {1u, 2u, 4u})
+        for (int delta : {0, 1, 5, 1000}) {
+          vector<int> expected_previous, previous;
+          vector<int> expected = dijkstra_shortest_path<BinaryHeapQueue>(G, source, expected_previous);
+          EXPECT_EQ(delta_stepping_shortest_path(G, source, previous, threads, delta), expected)
+              << threads << " threads, delta " << delta;
+          EXPECT_EQ(previous, expected_previous) << threads << " threads, delta " << delta;
+        }
+}
+
+TEST(DeltaStepping, SmallDeltaWithHeavyWeights) {
+  // Weights far beyond delta: the buckets must stay bounded rather than span every distance.
+  Graph G = random_graph(2000, 8000, 1000000, 15);
+  vector<int> expected_previous, previous;
+  vector<int> expected = dijkstra_shortest_path<BinaryHeapQueue>(G, 0, expected_previous);
+  for (unsigned threads : {1u, 4u}) {
+    EXPECT_EQ(delta_stepping_shortest_path(G, 0, previous, threads, 1), expected) << threads << " threads";
+    EXPECT_EQ(previous, expected_previous) << threads << " threads";
+  }
+}
+
+TEST(DeltaStepping, ZeroWeightEdges) {
+  Graph tied;
+  tied.numVertices = 3;
+  tied.resize(3);
+  tied[0].push_back(Edge(0, 1, 0));
+  tied[1].push_back(Edge(1, 0, 0));
+  tied[1].push_back(Edge(1, 2, 4));
+  vector<int> previous;
+  vector<int> tied_distances = delta_stepping_shortest_path(tied, 0, previous, 1, 1);
+  EXPECT_EQ(tied_distances, (vector<int>{0, 0, 4}));
+  EXPECT_EQ(previous, (vector<int>{-1, 0, 1}));
+  EXPECT_EQ(extract_shortest_path(tied_distances, previous, 2), (vector<int>{0, 1, 2}));
+
+  Graph G = random_graph(2000, 8000, 3, 14);
+  for (int u = 0; u < G.numVertices; u++)
+    for (Edge &edge : G[u])
+      edge.weight--;   // about a third of the edges now weigh 0
+  for (unsigned threads : {1u, 2u, 4u})
+    for (int delta : {1, 2}) {
+      vector<int> expected_previous;
+      vector<int> expected = dijkstra_shortest_path<BinaryHeapQueue>(G, 0, expected_previous);
+      vector<int> distances = delta_stepping_shortest_path(G, 0, previous, threads, delta);
+      ASSERT_EQ(distances, expected) << threads << " threads, delta " << delta;
+      EXPECT_EQ(previous[0], -1);
+      for (int v = 1; v < G.numVertices; v++) {
+        if (distances[v] == INF)
+          continue;
+        // previous[v] must be a tight edge, and following it must lead back to the source.
+        int u = previous[v];
+        ASSERT_NE(u, -1) << v;
+        bool tight = false;
+        for (const Edge &edge : G[u])
+          tight |= edge.dst == v && distances[u] + edge.weight == distances[v];
+        EXPECT_TRUE(tight) << u << " -> " << v;
+        int steps = 0;
+        for (int w = v; w != 0 && steps <= G.numVertices; w = previous[w])
+          steps++;
+        ASSERT_LE(steps, G.numVertices) << "previous cycles through " << v;
+      }
+    }
+}
+
+TEST(DeltaStepping, RejectsBadSource) {
+  Graph G = random_graph(10, 20, 5, 10);
+  vector<int> previous;
+  EXPECT_THROW(delta_stepping_shortest_path(G, 10, previous), runtime_error);
+}
+
+TEST(DynamicShortestPaths, UpdatesMatchRecomputation) {
+  for (unsigned seed : {11u, 12u, 13u}) {
+    Graph G = random_graph(300, 900, 10, seed);
+    DynamicShortestPaths paths(G, 0);
+    mt19937 rng(seed);
+    for (int step = 0; step < 400; step++) {
+      int u = rng() % G.numVertices;
+      const Graph &current = paths.graph();
+      switch (rng() % 3) {
+      case 0:
+        paths.insert_edge(Edge(u, rng() % G.numVertices, 1 + rng() % 10));
+        break;
+      case 1:
+        if (!current[u].empty())
+          paths.delete_edge(u, current[u][rng() % current[u].size()].dst);
+        break;
+      default:
+        if (!current[u].empty())
+          paths.set_weight(u, current[u][rng() % current[u].size()].dst, 1 + rng() % 10);
+      }
+      vector<int> previous;
+      ASSERT_EQ(paths.distances(), dijkstra_shortest_path<BinaryHeapQueue>(paths.graph(), 0, previous))
+          << "seed " << seed << " step " << step;
+      ASSERT_EQ(paths.previous(), previous) << "seed " << seed << " step " << step;
+    }
+  }
+}
+
+TEST(DynamicShortestPaths, RepairsOnlyTheAffectedSubtree) {
+  // A path 0 -> 1 -> ... -> 9 with a detour 0 -> 5 that is slightly longer.
+  Graph G;
+  G.numVertices = 10;
+  G.resize(10);
+  for (int v = 0; v + 1 < 10; v++)
+    G[v].push_back(Edge(v, v + 1, 1));
+  G[0].push_back(Edge(0, 5, 6));
+  DynamicShortestPaths paths(G, 0);
+  EXPECT_EQ(paths.previous()[5], 4);
+
+  paths.set_weight(3, 4, 5);
+  EXPECT_EQ(paths.last_update_size(), 6u);   // vertices 4..9
+  EXPECT_EQ(paths.distances()[4], 8);
+  EXPECT_EQ(paths.distances()[9], 10);
+  EXPECT_EQ(paths.previous()[5], 0);
+
+  paths.set_weight(8, 9, 3);
+  EXPECT_EQ(paths.last_update_size(), 1u);
+  EXPECT_EQ(paths.delete_edge(2, 7), 0);
+  EXPECT_EQ(paths.last_update_size(), 0u);
+  EXPECT_THROW(paths.set_weight(2, 7, 1), runtime_error);
+  EXPECT_THROW(paths.insert_edge(Edge(0, 10, 1)), runtime_error);
+}
+
+TEST(SearchTrace, CountsDijkstraWork) {
+  Graph G = random_graph(500, 3000, 20, 14);
+  SearchTrace trace;
+  vector<int> previous;
+  vector<int> distances = dijkstra_shortest_path(G, 0, previous);
+  extract_shortest_path(distances, previous, 42);
+  const SearchCounters &c = trace.counters;
+  if (!search_trace_enabled) {
+    EXPECT_EQ(c.heap_pushes + c.relaxations + c.nodes_expanded, 0);
+    EXPECT_TRUE(trace.phases.empty());
+    return;
+  }
+  long long reachable = count_if(distances.begin(), distances.end(), [](int d) { return d != INF; });
+  long long edges = 0;
+  for (int u = 0; u < G.numVertices; u++)
+    if (distances[u] != INF)
+      edges += G[u].size();
+  EXPECT_EQ(c.nodes_expanded, reachable);
+  EXPECT_EQ(c.heap_pushes, reachable + c.stale_pops);   // every push is popped once
+  EXPECT_EQ(c.relaxations, edges);
+  EXPECT_GT(c.peak_queue, 0);
+  ASSERT_EQ(trace.phases.size(), 2u);
+  EXPECT_STREQ(trace.phases[0].name, "search");
+  EXPECT_STREQ(trace.phases[1].name, "reconstruction");
+}
+
+TEST(SearchTrace, CountsLadderWorkAndExports) {
+  const WordGraph &graph = dictionary_graph();
+  LadderStats stats;
+  SearchTrace outer;
+  {
+    SearchTrace trace;
+    generate_word_ladder("sleep", "awake", graph, LadderMode::forward, &stats);
+    if (search_trace_enabled) {
+      EXPECT_EQ(trace.counters.nodes_expanded, stats.nodes_expanded);
+      EXPECT_GE(trace.counters.candidates_generated, trace.counters.nodes_expanded);
+      EXPECT_GE(trace.counters.dictionary_probes, 2);   // begin and end words
+      EXPECT_GT(trace.counters.peak_queue, 0);
+      vector<string> names;
+      for (const TracePhase &phase : trace.phases)
+        names.push_back(phase.name);
+      EXPECT_EQ(names, (vector<string>{"reconstruction", "search"}));
+    } else {
+      EXPECT_EQ(trace.counters.nodes_expanded, 0);
+    }
+    string json = trace.to_json();
+    EXPECT_EQ(json.front(), '{');
+    EXPECT_NE(json.find("\"nodes_expanded\": " + to_string(trace.counters.nodes_expanded)), string::npos);
+    EXPECT_NE(json.find("\"phases\": ["), string::npos);
+    string chrome = trace.to_chrome_trace();
+    EXPECT_NE(chrome.find("\"traceEvents\": ["), string::npos);
+    EXPECT_NE(chrome.find("\"ph\": \"C\""), string::npos);
+    EXPECT_EQ(chrome.find("\"ph\": \"X\"") != string::npos, search_trace_enabled);
+  }
+  // The inner trace collected everything while it was alive.
+  EXPECT_EQ(outer.counters.nodes_expanded, 0);
+  EXPECT_EQ(SearchTrace::active(), &outer);
+}
+
+TEST(LadderTree, MatchesPerQuerySearch) {
+  const WordGraph &graph = dictionary_graph();
+  mt19937 rng(15);
+  vector<string> begins = {"cat", "sleep", "code", "zzyzx", "qqq", "it's"};
+  for (int i = 0; i < 4; i++)
+    begins.emplace_back(graph.word(rng() % graph.size()));
+  for (const string &begin : begins) {
+    LadderTree tree = build_ladder_tree(begin, graph);
+    vector<string> ends = {"dog", "awake", "data", "cat", "its", "notaword"};
+    for (int i = 0; i < 40; i++)
+      ends.emplace_back(graph.word(rng() % graph.size()));
+    for (const string &end : ends) {
+      if (end != begin) {
+        ASSERT_EQ(generate_word_ladder(tree, end, graph), generate_word_ladder(begin, end, graph))
+            << begin << " -> " << end;
+      }
+    }
+    EXPECT_TRUE(generate_word_ladder(tree, begin, graph).empty());
+  }
+}
+
+TEST(LadderTree, CacheEvictsLeastRecentlyUsed) {
+  const WordGraph &graph = dictionary_graph();
+  size_t tree_bytes = build_ladder_tree("cat", graph).memory_bytes();
+  LadderTreeCache cache(graph, 2 * tree_bytes + tree_bytes / 2);   // room for two trees
+
+  EXPECT_EQ(cache.ladder("cat", "dog"), generate_word_ladder("cat", "dog", graph));
+  EXPECT_EQ(cache.ladder("code", "data"), generate_word_ladder("code", "data", graph));
+  EXPECT_EQ(cache.ladder("cat", "cot"), generate_word_ladder("cat", "cot", graph));   // hit, now most recent
+  EXPECT_EQ(cache.ladder("work", "play"), generate_word_ladder("work", "play", graph)); // evicts "code"
+  EXPECT_EQ(cache.size(), 2u);
+  EXPECT_LE(cache.memory_used(), 2 * tree_bytes + tree_bytes / 2);
+  EXPECT_EQ(cache.hits(), 1u);
+  EXPECT_EQ(cache.misses(), 3u);
+
+  shared_ptr<const LadderTree> cat = cache.tree("cat");
+  cache.tree("work");
+  cache.tree("code");   // evicts "cat"
+  EXPECT_EQ(cache.hits(), 3u);
+  EXPECT_EQ(cache.misses(), 4u);
+  EXPECT_EQ(cat->begin_word, "cat");   // still valid after its eviction
+  cache.tree("cat");
+  EXPECT_EQ(cache.misses(), 5u);
+  EXPECT_TRUE(cache.ladder("cat", "cat").empty());
 
-TEST(Replace, Me) {
-  EXPECT_TRUE(false);
+  LadderTreeCache tiny(graph, tree_bytes / 2);
+  EXPECT_EQ(tiny.ladder("cat", "dog"), generate_word_ladder("cat", "dog", graph));
+  EXPECT_EQ(tiny.size(), 0u);
+  EXPECT_EQ(tiny.memory_used(), 0u);
 }
@@ -0,0 +1,5 @@
+#pragma once
+
+// Global operator new calls so far in this process. Defined in alloc_counter.cpp, which also
+// replaces the global allocation functions, so only executables that link it can call this.
+long allocation_count();
@@ -0,0 +1,16 @@
+#include "ladder.h"
+
+// Compiles a word list into the binary image that load_word_graph maps at startup.
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        cerr << "Usage: " << argv[0] << " <words.txt> <image>" << endl;
+        return 1;
+    }
+    set<string> word_list;
+    load_words(word_list, argv[1]);
+    WordGraph graph(word_list);
+    save_word_graph(graph, argv[2]);
+    cout << "Wrote " << graph.size() << " words, " << graph.adj.size() << " edges, "
+         << graph.image.size() << " bytes to " << argv[2] << "\n";
+    return 0;
+}
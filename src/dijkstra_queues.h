@@ -0,0 +1,202 @@
+#pragma once
+
+#include <vector>
+#include <queue>
+#include <array>
+#include <bit>
+#include <cstdint>
+
+using namespace std;
+
+struct Node {
+    int vertex;
+    int distance;
+    Node(int v, int d) : vertex(v), distance(d) {}
+};
+
+struct NodeCompare {
+    bool operator()(const Node &a, const Node &b) {
+        return a.distance > b.distance;
+    }
+};
+
+/*
+  Priority queue policies for dijkstra_shortest_path<Queue>.
+  Each is constructed with the vertex count and offers empty(), size(), push(vertex, distance), which
+  inserts the vertex or lowers its distance, and pop(), which removes an entry of smallest
+  distance. Queues that implement push by inserting duplicates may pop stale entries for
+  vertices that were settled since; the search skips those. reset() readies a drained queue
+  for another search while keeping its storage.
+*/
+
+// std::priority_queue with lazy deletion; every improvement pushes another entry.
+class BinaryHeapQueue {
+public:
+    explicit BinaryHeapQueue(int /*numVertices*/) {}
+    bool empty() const { return pq.empty(); }
+    size_t size() const { return pq.size(); }
+    void push(int vertex, int distance) { pq.push(Node(vertex, distance)); }
+    void reset() {}
+    Node pop() {
+        Node top = pq.top();
+        pq.pop();
+        return top;
+    }
+
+private:
+    priority_queue<Node, vector<Node>, NodeCompare> pq;
+};
+
+// Indexed D-ary heap with true decrease-key: at most one entry per vertex, never stale.
+template <int D = 4>
+class IndexedDaryHeapQueue {
+public:
+    explicit IndexedDaryHeapQueue(int numVertices) : position(numVertices, -1), key(numVertices) {}
+    bool empty() const { return heap.empty(); }
+    size_t size() const { return heap.size(); }
+    void reset() {}
+    void push(int vertex, int distance) {
+        if (position[vertex] == -1) {
+            position[vertex] = heap.size();
+            heap.push_back(vertex);
+        } else if (distance >= key[vertex]) {
+            return;
+        }
+        key[vertex] = distance;
+        sift_up(position[vertex]);
+    }
+    Node pop() {
+        int top = heap.front();
+        position[top] = -1;
+        int last = heap.back();
+        heap.pop_back();
+        if (!heap.empty()) {
+            heap[0] = last;
+            position[last] = 0;
+            sift_down(0);
+        }
+        return Node(top, key[top]);
+    }
+
+private:
+    void place(int i, int vertex) {
+        heap[i] = vertex;
+        position[vertex] = i;
+    }
+    void sift_up(int i) {
+        int vertex = heap[i];
+        while (i > 0) {
+            int parent = (i - 1) / D;
+            if (key[heap[parent]] <= key[vertex]) break;
+            place(i, heap[parent]);
+            i = parent;
+        }
+        place(i, vertex);
+    }
+    void sift_down(int i) {
+        int vertex = heap[i];
+        int n = heap.size();
+        for (;;) {
+            int first = D * i + 1, best = -1;
+            for (int c = first; c < first + D && c < n; c++)
+                if (best == -1 || key[heap[c]] < key[heap[best]])
+                    best = c;
+            if (best == -1 || key[heap[best]] >= key[vertex]) break;
+            place(i, heap[best]);
+            i = best;
+        }
+        place(i, vertex);
+    }
+
+    vector<int> heap;       // vertices in heap order
+    vector<int> position;   // index of each vertex in heap, or -1
+    vector<int> key;        // current distance of each queued vertex
+};
+
+// Radix heap for monotone non-negative integer keys: bucket b holds keys whose highest bit
+// differing from the last popped key is bit b - 1. Improvements insert duplicates.
+class RadixHeapQueue {
+public:
+    explicit RadixHeapQueue(int /*numVertices*/) {}
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+    void reset() { last = 0; }
+    void push(int vertex, int distance) {
+        buckets[bucket_of(distance)].push_back(Node(vertex, distance));
+        count++;
+    }
+    Node pop() {
+        if (buckets[0].empty()) {
+            int b = 1;
+            while (buckets[b].empty())
+                b++;
+            last = buckets[b].front().distance;
+            for (const Node &node : buckets[b])
+                last = min(last, node.distance);
+            for (const Node &node : buckets[b])
+                buckets[bucket_of(node.distance)].push_back(node);
+            buckets[b].clear();
+        }
+        Node top = buckets[0].back();
+        buckets[0].pop_back();
+        count--;
+        return top;
+    }
+
+private:
+    int bucket_of(int distance) const {
+        return bit_width(static_cast<uint32_t>(distance ^ last));
+    }
+
+    array<vector<Node>, 33> buckets;
+    int last = 0;
+    size_t count = 0;
+};
+
+// Largest edge weight for which DijkstraQueue::dial is run or tried by fastest_queue; the
+// ring would otherwise need one bucket per unit of weight.
+constexpr int DIAL_MAX_WEIGHT = 1 << 16;
+
+// Dial's algorithm: a circular array of buckets, one per distance, scanned forward from the
+// last popped distance. The ring doubles whenever an edge weight outgrows it, so it ends up
+// just larger than the largest weight seen. Improvements insert duplicates.
+class DialQueue {
+public:
+    explicit DialQueue(int /*numVertices*/) : buckets(64) {}
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+    void reset() { current = 0; }
+    void push(int vertex, int distance) {
+        if (size_t(distance - current) >= buckets.size())
+            grow(distance - current + 1);
+        buckets[distance & (buckets.size() - 1)].push_back(vertex);
+        count++;
+    }
+    Node pop() {
+        size_t mask = buckets.size() - 1;
+        while (buckets[current & mask].empty())
+            current++;
+        vector<int> &bucket = buckets[current & mask];
+        int vertex = bucket.back();
+        bucket.pop_back();
+        count--;
+        return Node(vertex, current);
+    }
+
+private:
+    void grow(size_t span) {
+        vector<vector<int>> old;
+        old.swap(buckets);
+        buckets.resize(bit_ceil(span));
+        size_t old_mask = old.size() - 1;
+        for (size_t k = 0; k < old.size(); k++) {
+            int distance = current + int((k - current) & old_mask);
+            for (int vertex : old[k])
+                buckets[distance & (buckets.size() - 1)].push_back(vertex);
+        }
+    }
+
+    vector<vector<int>> buckets;   // power-of-two ring indexed by distance
+    int current = 0;               // smallest distance that can still be queued
+    size_t count = 0;
+};
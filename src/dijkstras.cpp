@@ -1,56 +1,910 @@
 #include "dijkstras.h"
+#include "search_trace.h"
 #include <iostream>
 #include <queue>
 #include <vector>
 #include <limits>
 #include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <atomic>
+#include <barrier>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 using namespace std;
 
-struct Node {
-    int vertex;
-    int distance;
-    Node(int v, int d) : vertex(v), distance(d) {}
-};
+// Calls visit(dst, weight) for every edge leaving u, in input order.
+template <typename Visit>
+static void for_each_edge(const Graph& G, int u, Visit visit) {
+    for (const Edge &edge : G[u])
+        visit(edge.dst, edge.weight);
+}
 
-struct NodeCompare {
-    bool operator()(const Node &a, const Node &b) {
-        return a.distance > b.distance;
-    }
-};
+template <typename Visit>
+static void for_each_edge(const CsrGraph& G, int u, Visit visit) {
+    for (int k = G.offsets[u]; k < G.offsets[u + 1]; k++)
+        visit(G.dst[k], G.weight[k]);
+}
 
-vector<int> dijkstra_shortest_path(const Graph& G, int source, vector<int>& previous) {
-    vector<int> distances(G.numVertices, INF);
-    vector<bool> visited(G.numVertices, false);
-    previous.assign(G.numVertices, -1);
+// Plain Dijkstra: every vertex has potential 0.
+struct ZeroPotential {
+    int operator()(int /*v*/) const { return 0; }
+};
 
-    priority_queue<Node, vector<Node>, NodeCompare> pq;
+/*
+  Shared search loop over caller-owned arrays: distances and previous must hold INF and -1,
+  visited must be all false and pq must be empty. The queue is keyed by distance +
+  potential(v), so a non-zero potential turns it into A*; potential(v) == INF marks v as
+  unable to reach the target and it is never queued. The search stops as soon as target (if
+  not -1) is settled, possibly leaving entries in pq; every settled vertex already has its
+  final distance and previous. An equally short route from a smaller vertex also replaces
+  previous[v], so the order in which the queue pops ties never shows in previous.
+*/
+template <typename Queue, typename GraphType, typename Potential>
+static void search(const GraphType& G, int source, int* distances, int* previous, char* visited, Queue& pq,
+                   int target, Potential potential) {
+    TRACE_PHASE("search");
     distances[source] = 0;
-    pq.push(Node(source, 0));
+    pq.push(source, potential(source));
+    TRACE_ADD(heap_pushes, 1);
 
     while (!pq.empty()) {
-        Node current = pq.top();
-        pq.pop();
+        TRACE_MAX(peak_queue, pq.size());
+        Node current = pq.pop();
         int u = current.vertex;
 
-        if (visited[u])
+        if (visited[u]) {
+            TRACE_ADD(stale_pops, 1);
             continue;
+        }
         visited[u] = true;
+        if (u == target)
+            break;
+        TRACE_ADD(nodes_expanded, 1);
 
-        for (const Edge &edge : G[u]) {
-            int v = edge.dst;
-            int weight = edge.weight;
-            if (!visited[v] && distances[u] != INF && distances[u] + weight < distances[v]) {
-                distances[v] = distances[u] + weight;
+        for_each_edge(G, u, [&](int v, int weight) {
+            TRACE_ADD(relaxations, 1);
+            if (visited[v] || distances[u] == INF)
+                return;
+            int distance = distances[u] + weight;
+            if (distance < distances[v]) {
+                int h = potential(v);
+                if (h == INF)
+                    return;
+                distances[v] = distance;
+                previous[v] = u;
+                pq.push(v, distance + h);
+                TRACE_ADD(heap_pushes, 1);
+            } else if (distance == distances[v] && u < previous[v]) {
                 previous[v] = u;
-                pq.push(Node(v, distances[v]));
             }
+        });
+    }
+}
+
+template <typename Queue, typename GraphType, typename Potential = ZeroPotential>
+static vector<int> dijkstra(const GraphType& G, int source, vector<int>& previous,
+                            int target = -1, Potential potential = Potential()) {
+    vector<int> distances(G.numVertices, INF);
+    vector<char> visited(G.numVertices, false);
+    previous.assign(G.numVertices, -1);
+    Queue pq(G.numVertices);
+    search(G, source, distances.data(), previous.data(), visited.data(), pq, target, potential);
+    return distances;
+}
+
+vector<int> dijkstra_shortest_path(const Graph& G, int source, vector<int>& previous) {
+    return dijkstra<BinaryHeapQueue>(G, source, previous);
+}
+
+vector<int> dijkstra_shortest_path(const CsrGraph& G, int source, vector<int>& previous) {
+    return dijkstra<BinaryHeapQueue>(G, source, previous);
+}
+
+template <typename Queue>
+vector<int> dijkstra_shortest_path(const Graph& G, int source, vector<int>& previous) {
+    return dijkstra<Queue>(G, source, previous);
+}
+
+template <typename Queue>
+vector<int> dijkstra_shortest_path(const CsrGraph& G, int source, vector<int>& previous) {
+    return dijkstra<Queue>(G, source, previous);
+}
+
+#define INSTANTIATE_DIJKSTRA(Queue) \
+    template vector<int> dijkstra_shortest_path<Queue>(const Graph&, int, vector<int>&); \
+    template vector<int> dijkstra_shortest_path<Queue>(const CsrGraph&, int, vector<int>&);
+INSTANTIATE_DIJKSTRA(BinaryHeapQueue)
+INSTANTIATE_DIJKSTRA(IndexedDaryHeapQueue<4>)
+INSTANTIATE_DIJKSTRA(RadixHeapQueue)
+INSTANTIATE_DIJKSTRA(DialQueue)
+#undef INSTANTIATE_DIJKSTRA
+
+const char* queue_name(DijkstraQueue queue) {
+    switch (queue) {
+    case DijkstraQueue::binary_heap: return "binary_heap";
+    case DijkstraQueue::dary_heap: return "dary_heap";
+    case DijkstraQueue::radix_heap: return "radix_heap";
+    case DijkstraQueue::dial: return "dial";
+    }
+    return "unknown";
+}
+
+template <typename GraphType>
+static int max_edge_weight(const GraphType& G) {
+    int max_weight = 0;
+    for (int u = 0; u < G.numVertices; u++)
+        for_each_edge(G, u, [&](int, int weight) { max_weight = max(max_weight, weight); });
+    return max_weight;
+}
+
+// Dial's ring grows to the largest edge weight, so above DIAL_MAX_WEIGHT the radix heap,
+// which gives the same distances and previous, runs in its place.
+template <typename GraphType>
+static DijkstraQueue usable_queue(const GraphType& G, DijkstraQueue queue) {
+    if (queue == DijkstraQueue::dial && max_edge_weight(G) > DIAL_MAX_WEIGHT)
+        return DijkstraQueue::radix_heap;
+    return queue;
+}
+
+template <typename GraphType>
+static vector<int> dijkstra_with(const GraphType& G, int source, vector<int>& previous, DijkstraQueue queue) {
+    switch (usable_queue(G, queue)) {
+    case DijkstraQueue::dary_heap: return dijkstra<IndexedDaryHeapQueue<4>>(G, source, previous);
+    case DijkstraQueue::radix_heap: return dijkstra<RadixHeapQueue>(G, source, previous);
+    case DijkstraQueue::dial: return dijkstra<DialQueue>(G, source, previous);
+    default: return dijkstra<BinaryHeapQueue>(G, source, previous);
+    }
+}
+
+vector<int> dijkstra_shortest_path(const Graph& G, int source, vector<int>& previous, DijkstraQueue queue) {
+    return dijkstra_with(G, source, previous, queue);
+}
+
+vector<int> dijkstra_shortest_path(const CsrGraph& G, int source, vector<int>& previous, DijkstraQueue queue) {
+    return dijkstra_with(G, source, previous, queue);
+}
+
+template <typename GraphType>
+static DijkstraQueue fastest(const GraphType& G, int source) {
+    DijkstraQueue best = DijkstraQueue::binary_heap;
+    auto best_time = chrono::steady_clock::duration::max();
+    vector<int> previous;
+    vector<DijkstraQueue> candidates = {DijkstraQueue::binary_heap, DijkstraQueue::dary_heap, DijkstraQueue::radix_heap};
+    if (max_edge_weight(G) <= DIAL_MAX_WEIGHT)
+        candidates.push_back(DijkstraQueue::dial);
+    for (DijkstraQueue queue : candidates) {
+        // Best of three runs, so one cold cache or page fault doesn't decide.
+        auto elapsed = chrono::steady_clock::duration::max();
+        for (int run = 0; run < 3; run++) {
+            auto start = chrono::steady_clock::now();
+            dijkstra_with(G, source, previous, queue);
+            elapsed = min(elapsed, chrono::steady_clock::now() - start);
+        }
+        if (elapsed < best_time) {
+            best_time = elapsed;
+            best = queue;
         }
     }
+    return best;
+}
+
+DijkstraQueue fastest_queue(const Graph& G, int source) {
+    return fastest(G, source);
+}
+
+DijkstraQueue fastest_queue(const CsrGraph& G, int source) {
+    return fastest(G, source);
+}
+
+vector<int> dijkstra_point_to_point(const Graph& G, int source, int target, vector<int>& previous) {
+    return dijkstra<BinaryHeapQueue>(G, source, previous, target);
+}
+
+vector<int> dijkstra_point_to_point(const CsrGraph& G, int source, int target, vector<int>& previous) {
+    return dijkstra<BinaryHeapQueue>(G, source, previous, target);
+}
+
+// G with every edge reversed, rows in order of the original source vertex.
+template <typename GraphType>
+static CsrGraph reverse_graph(const GraphType& G) {
+    CsrGraph R;
+    R.numVertices = G.numVertices;
+    R.offsets.assign(G.numVertices + 1, 0);
+    for (int u = 0; u < G.numVertices; u++)
+        for_each_edge(G, u, [&](int v, int) { R.offsets[v + 1]++; });
+    for (int v = 0; v < G.numVertices; v++)
+        R.offsets[v + 1] += R.offsets[v];
+    R.dst.resize(R.offsets.back());
+    R.weight.resize(R.offsets.back());
+    vector<int> next(R.offsets.begin(), R.offsets.end() - 1);
+    for (int u = 0; u < G.numVertices; u++)
+        for_each_edge(G, u, [&](int v, int weight) {
+            R.dst[next[v]] = u;
+            R.weight[next[v]++] = weight;
+        });
+    return R;
+}
+
+/*
+  Landmark selection is the usual farthest-point heuristic: start from vertex 0, then keep
+  adding the reachable vertex whose distance to the nearest landmark so far is largest.
+  Distances from each landmark come from G and distances to it from the reversed graph.
+*/
+template <typename GraphType>
+static AltLandmarks landmarks_for(const GraphType& G, int count) {
+    AltLandmarks L;
+    int n = G.numVertices;
+    count = min(count, n);
+    CsrGraph R = reverse_graph(G);
+    vector<int> previous, nearest(n, INF);
+    vector<vector<int>> from, to;
+    int next = 0;
+    for (int i = 0; i < count && next != -1; i++) {
+        L.landmarks.push_back(next);
+        from.push_back(dijkstra<BinaryHeapQueue>(G, next, previous));
+        to.push_back(dijkstra<BinaryHeapQueue>(R, next, previous));
+        next = -1;
+        for (int v = 0; v < n; v++) {
+            if (from.back()[v] != INF)
+                nearest[v] = nearest[v] == INF ? from.back()[v] : min(nearest[v], from.back()[v]);
+            if (nearest[v] != INF && nearest[v] > 0 && (next == -1 || nearest[v] > nearest[next]))
+                next = v;
+        }
+    }
+    int k = L.landmarks.size();
+    L.from.resize(size_t(n) * k);
+    L.to.resize(size_t(n) * k);
+    for (int i = 0; i < k; i++)
+        for (int v = 0; v < n; v++) {
+            L.from[size_t(v) * k + i] = from[i][v];
+            L.to[size_t(v) * k + i] = to[i][v];
+        }
+    return L;
+}
+
+AltLandmarks build_landmarks(const Graph& G, int count) {
+    return landmarks_for(G, count);
+}
+
+AltLandmarks build_landmarks(const CsrGraph& G, int count) {
+    return landmarks_for(G, count);
+}
+
+int AltLandmarks::lower_bound(int v, int target) const {
+    int k = landmarks.size();
+    const int *from_v = &from[size_t(v) * k], *from_t = &from[size_t(target) * k];
+    const int *to_v = &to[size_t(v) * k], *to_t = &to[size_t(target) * k];
+    int bound = 0;
+    for (int i = 0; i < k; i++) {
+        // d(L, t) <= d(L, v) + d(v, t): if L reaches v but not t, neither does v.
+        if (from_v[i] != INF) {
+            if (from_t[i] == INF) return INF;
+            bound = max(bound, from_t[i] - from_v[i]);
+        }
+        // d(v, L) <= d(v, t) + d(t, L): if t reaches L but v does not, v cannot reach t.
+        if (to_t[i] != INF) {
+            if (to_v[i] == INF) return INF;
+            bound = max(bound, to_v[i] - to_t[i]);
+        }
+    }
+    return bound;
+}
+
+template <typename GraphType>
+static vector<int> alt_search(const GraphType& G, const AltLandmarks& L, int source, int target, vector<int>& previous) {
+    if (L.landmarks.empty())
+        return dijkstra<BinaryHeapQueue>(G, source, previous, target);
+    return dijkstra<BinaryHeapQueue>(G, source, previous, target,
+                                     [&](int v) { return L.lower_bound(v, target); });
+}
+
+vector<int> alt_shortest_path(const Graph& G, const AltLandmarks& L, int source, int target, vector<int>& previous) {
+    return alt_search(G, L, source, target, previous);
+}
+
+vector<int> alt_shortest_path(const CsrGraph& G, const AltLandmarks& L, int source, int target, vector<int>& previous) {
+    return alt_search(G, L, source, target, previous);
+}
+
+static bool is_space(char c) {
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+// Read-only mapping of a whole file, unmapped on destruction.
+struct MappedFile {
+    const char* data = nullptr;
+    size_t size = 0;
+
+    explicit MappedFile(const string& filename) {
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw runtime_error("Can't open input file");
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void *mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped != MAP_FAILED) {
+                data = static_cast<const char*>(mapped);
+                size = st.st_size;
+            }
+        }
+        close(fd);
+    }
+    ~MappedFile() {
+        if (data)
+            munmap(const_cast<char*>(data), size);
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+};
+
+// Runs body(0) .. body(count - 1), one std::thread per index beyond the first, and
+// rethrows the first exception any of them raised.
+template <typename Body>
+static void parallel_for(unsigned count, Body body) {
+    vector<exception_ptr> errors(count);
+    auto run = [&](unsigned i) {
+        try {
+            body(i);
+        } catch (...) {
+            errors[i] = current_exception();
+        }
+    };
+    vector<thread> workers;
+    for (unsigned i = 1; i < count; i++)
+        workers.emplace_back(run, i);
+    run(0);
+    for (thread &t : workers)
+        t.join();
+    for (const exception_ptr &e : errors)
+        if (e)
+            rethrow_exception(e);
+}
+
+/*
+  CSR loader:
+  The mapped text is cut into one chunk per thread at whitespace, so no token straddles two
+  chunks. Pass 1 counts the tokens in each chunk; a prefix sum then tells every chunk the
+  global index of its first token, and with it which edge each of its tokens belongs to
+  (token 0 is the vertex count, edge k is tokens 3k+1 .. 3k+3). Pass 2 parses each chunk's
+  edges with from_chars into arrays sized from the count, reading past the chunk end to finish
+  an edge that starts inside it. A counting sort by source then lays the edges out as CSR rows
+  while keeping file order within each row, exactly as Graph's push_back would.
+*/
+void file_to_graph(const string& filename, CsrGraph& G, unsigned threads) {
+    MappedFile file(filename);
+    const char *text = file.data, *text_end = file.data + file.size;
+    threads = max(1u, threads);
+
+    vector<const char*> bounds = {text};
+    for (unsigned c = 1; c < threads; c++) {
+        const char *p = max(bounds.back(), text + file.size * c / threads);
+        while (p < text_end && !is_space(*p))
+            p++;
+        bounds.push_back(p);
+    }
+    bounds.push_back(text_end);
+
+    vector<size_t> first_token(threads + 1, 0);
+    parallel_for(threads, [&](unsigned c) {
+        size_t tokens = 0;
+        bool in_token = false;
+        for (const char *p = bounds[c]; p < bounds[c + 1]; p++) {
+            bool space = is_space(*p);
+            tokens += in_token == false && !space;
+            in_token = !space;
+        }
+        first_token[c + 1] = tokens;
+    });
+    for (unsigned c = 0; c < threads; c++)
+        first_token[c + 1] += first_token[c];
+    if (first_token[threads] == 0)
+        throw runtime_error("Unable to find input file");
+
+    auto malformed = [] { throw runtime_error("Malformed graph file"); };
+    auto parse = [&](const char*& p, int& value) {
+        while (p < text_end && is_space(*p))
+            p++;
+        auto [end, ec] = from_chars(p, text_end, value);
+        if (ec != errc() || (end < text_end && !is_space(*end)))
+            malformed();
+        p = end;
+    };
+
+    const char *p = text;
+    parse(p, G.numVertices);
+    if (G.numVertices < 0)
+        malformed();
+    if ((first_token[threads] - 1) % 3 != 0)
+        malformed();   // a trailing partial edge
+    size_t edges = (first_token[threads] - 1) / 3;
+    vector<int> src(edges), dst(edges), weight(edges);
+
+    parallel_for(threads, [&](unsigned c) {
+        // Skip the vertex count and the tail of an edge that began in the previous chunk.
+        size_t t = first_token[c];
+        const char *q = bounds[c];
+        for (int skipped; t < first_token[c + 1] && (t == 0 || (t - 1) % 3 != 0); t++)
+            parse(q, skipped);
+        for (; t < first_token[c + 1] && (t - 1) / 3 < edges; t += 3) {
+            size_t e = (t - 1) / 3;
+            parse(q, src[e]);
+            parse(q, dst[e]);
+            parse(q, weight[e]);
+            if (src[e] < 0 || src[e] >= G.numVertices || dst[e] < 0 || dst[e] >= G.numVertices)
+                malformed();
+        }
+    });
+
+    G.offsets.assign(size_t(G.numVertices) + 1, 0);
+    for (int u : src)
+        G.offsets[u + 1]++;
+    for (int u = 0; u < G.numVertices; u++)
+        G.offsets[u + 1] += G.offsets[u];
+    vector<int> next(G.offsets.begin(), G.offsets.end() - 1);
+    G.dst.resize(edges);
+    G.weight.resize(edges);
+    for (size_t e = 0; e < edges; e++) {
+        int k = next[src[e]]++;
+        G.dst[k] = dst[e];
+        G.weight[k] = weight[e];
+    }
+}
+
+// Threads to use for jobs independent tasks: threads, or one per core if 0, but at most jobs.
+static unsigned worker_count(unsigned threads, size_t jobs) {
+    if (threads == 0)
+        threads = max(1u, thread::hardware_concurrency());
+    return max<size_t>(1, min<size_t>(threads, jobs));
+}
+
+/*
+  Many-source engine: workers claim sources one at a time from a shared counter, so a few
+  expensive searches do not hold up the rest. Each worker owns one workspace (previous,
+  visited and a queue) for the whole call; a full search drains the queue, so after reset()
+  the same one serves every source the worker claims. row_for(i) gives the array the distances of
+  sources[i] are written to, and row_done(i, row) is called once it is final.
+*/
+template <typename Queue, typename GraphType, typename RowFor, typename RowDone>
+static void many_sources(const GraphType& G, const vector<int>& sources, unsigned threads,
+                         RowFor row_for, RowDone row_done) {
+    int n = G.numVertices;
+    for (int source : sources)
+        if (source < 0 || source >= n)
+            throw runtime_error("Source vertex out of range");
+    threads = worker_count(threads, sources.size());
+    atomic<size_t> next{0};
+    parallel_for(threads, [&](unsigned w) {
+        vector<int> previous(n);
+        vector<char> visited(n);
+        Queue pq(n);
+        for (size_t i; (i = next.fetch_add(1, memory_order_relaxed)) < sources.size();) {
+            int* distances = row_for(w, i);
+            fill(distances, distances + n, INF);
+            fill(previous.begin(), previous.end(), -1);
+            fill(visited.begin(), visited.end(), false);
+            pq.reset();
+            search(G, sources[i], distances, previous.data(), visited.data(), pq, -1, ZeroPotential());
+            row_done(i, span<const int>(distances, n));
+        }
+    });
+}
+
+template <typename GraphType, typename RowFor, typename RowDone>
+static void many_sources_with(const GraphType& G, const vector<int>& sources, unsigned threads, DijkstraQueue queue,
+                              RowFor row_for, RowDone row_done) {
+    switch (usable_queue(G, queue)) {
+    case DijkstraQueue::dary_heap:
+        return many_sources<IndexedDaryHeapQueue<4>>(G, sources, threads, row_for, row_done);
+    case DijkstraQueue::radix_heap: return many_sources<RadixHeapQueue>(G, sources, threads, row_for, row_done);
+    case DijkstraQueue::dial: return many_sources<DialQueue>(G, sources, threads, row_for, row_done);
+    default: return many_sources<BinaryHeapQueue>(G, sources, threads, row_for, row_done);
+    }
+}
+
+template <typename GraphType>
+static void matrix_from(const GraphType& G, const vector<int>& sources, span<int> matrix, unsigned threads,
+                        DijkstraQueue queue) {
+    size_t n = G.numVertices;
+    if (matrix.size() != sources.size() * n)
+        throw runtime_error("Distance matrix must have sources.size() * numVertices entries");
+    many_sources_with(G, sources, threads, queue,
+                      [&](unsigned, size_t i) { return matrix.data() + i * n; },
+                      [](size_t, span<const int>) {});
+}
+
+template <typename GraphType>
+static void stream_from(const GraphType& G, const vector<int>& sources, const DistanceRowSink& sink,
+                        unsigned threads, DijkstraQueue queue) {
+    vector<vector<int>> rows(worker_count(threads, sources.size()));
+    mutex sink_mutex;
+    many_sources_with(G, sources, threads, queue,
+                      [&](unsigned w, size_t) {
+                          rows[w].resize(G.numVertices);
+                          return rows[w].data();
+                      },
+                      [&](size_t i, span<const int> row) {
+                          lock_guard<mutex> lock(sink_mutex);
+                          sink(i, row);
+                      });
+}
+
+void multi_source_distances(const Graph& G, const vector<int>& sources, span<int> matrix, unsigned threads,
+                            DijkstraQueue queue) {
+    matrix_from(G, sources, matrix, threads, queue);
+}
+
+void multi_source_distances(const CsrGraph& G, const vector<int>& sources, span<int> matrix, unsigned threads,
+                            DijkstraQueue queue) {
+    matrix_from(G, sources, matrix, threads, queue);
+}
+
+void multi_source_distances(const Graph& G, const vector<int>& sources, const DistanceRowSink& sink,
+                            unsigned threads, DijkstraQueue queue) {
+    stream_from(G, sources, sink, threads, queue);
+}
+
+void multi_source_distances(const CsrGraph& G, const vector<int>& sources, const DistanceRowSink& sink,
+                            unsigned threads, DijkstraQueue queue) {
+    stream_from(G, sources, sink, threads, queue);
+}
+
+template <typename GraphType>
+static vector<int> all_pairs(const GraphType& G, unsigned threads, DijkstraQueue queue) {
+    vector<int> sources(G.numVertices);
+    for (int v = 0; v < G.numVertices; v++)
+        sources[v] = v;
+    vector<int> matrix(size_t(G.numVertices) * G.numVertices);
+    matrix_from(G, sources, matrix, threads, queue);
+    return matrix;
+}
+
+vector<int> all_pairs_distances(const Graph& G, unsigned threads, DijkstraQueue queue) {
+    return all_pairs(G, threads, queue);
+}
+
+vector<int> all_pairs_distances(const CsrGraph& G, unsigned threads, DijkstraQueue queue) {
+    return all_pairs(G, threads, queue);
+}
+
+/*
+  Delta-stepping (Meyer & Sanders). Vertices are kept in buckets of width delta by tentative
+  distance, and the smallest non-empty bucket is settled in rounds: every round relaxes the
+  light edges (weight < delta) of the vertices currently in the bucket, which may put
+  vertices back into it. Once a round adds nothing, the distances in the bucket are final
+  and the heavy edges of everything it held are relaxed once, into later buckets.
+
+  Each vertex's distance and predecessor share one 64-bit word, distance in the high half,
+  updated by an atomic min. Every vertex relaxes its edges at its final distance at least
+  once, so with positive weights the word ends up holding the smallest tight predecessor,
+  the same previous the queue policies produce, whatever the thread interleaving. The
+  source never takes a predecessor, and zero-weight edges only replace strictly longer
+  labels, so previous always forms a tree rooted at the source.
+
+  Threads run the phases in lockstep around a barrier. Each thread files the vertices it
+  improves into its own cyclic array of bucket lists, and thread 0 merges those lists (dropping stale and
+  repeated entries) into the shared frontier between rounds.
+*/
+constexpr int DELTA_MAX_BUCKETS = 1 << 16;
+
+static uint64_t pack_label(int distance, int predecessor) {
+    return uint64_t(uint32_t(distance)) << 32 | uint32_t(predecessor);
+}
+
+template <typename GraphType>
+static int default_delta(const GraphType& G) {
+    long long edges = 0;
+    int max_weight = 1;
+    for (int u = 0; u < G.numVertices; u++)
+        for_each_edge(G, u, [&](int, int weight) {
+            edges++;
+            max_weight = max(max_weight, weight);
+        });
+    long long degree = G.numVertices == 0 ? 1 : max(1LL, edges / G.numVertices);
+    return max(1LL, max_weight / degree);
+}
+
+template <typename GraphType>
+static vector<int> delta_stepping(const GraphType& G, int source, vector<int>& previous, unsigned threads,
+                                  int delta) {
+    int n = G.numVertices;
+    if (source < 0 || source >= n)
+        throw runtime_error("Source vertex out of range");
+    if (delta <= 0)
+        delta = default_delta(G);
+    // Live buckets span at most max_weight / delta + 2 consecutive indices, so they fit a
+    // ring of that many slots; a delta too small for DELTA_MAX_BUCKETS slots is widened.
+    int max_weight = max_edge_weight(G);
+    if (max_weight / delta + 2 > DELTA_MAX_BUCKETS)
+        delta = max_weight / (DELTA_MAX_BUCKETS - 2) + 1;
+    size_t ring = max_weight / delta + 2;
+    threads = worker_count(threads, n);
+
+    vector<atomic<uint64_t>> label(n);
+    for (int v = 0; v < n; v++)
+        label[v].store(pack_label(INF, -1), memory_order_relaxed);
+    label[source].store(pack_label(0, -1), memory_order_relaxed);
+    auto distance_of = [&](int v) { return int(label[v].load(memory_order_relaxed) >> 32); };
+
+    // buckets[thread][bucket % ring]
+    vector<vector<vector<int>>> buckets(threads, vector<vector<int>>(ring));
+    buckets[0][0].push_back(source);
+    vector<int> frontier, settled;
+    vector<unsigned> round_mark(n, 0), settled_mark(n, 0);
+    unsigned round = 0;
+    size_t current = 0;
+    bool done = false, bucket_done = false;
+    atomic<size_t> next{0};
+    barrier sync(threads);
+
+    // Relaxes the edges of u whose weight is light (or heavy), filing improved targets.
+    auto relax = [&](unsigned t, int u, bool light) {
+        int du = distance_of(u);
+        for_each_edge(G, u, [&](int v, int weight) {
+            if ((weight < delta) != light || v == source)
+                return;
+            int distance = du + weight;
+            uint64_t wanted = pack_label(distance, u);
+            uint64_t seen = label[v].load(memory_order_relaxed);
+            bool shorter = false;
+            // A zero-weight edge only counts when it shortens v: swapping predecessors between
+            // vertices tied at the same distance could close a cycle.
+            while (wanted < seen && (weight > 0 || distance < int(seen >> 32))) {
+                if (label[v].compare_exchange_weak(seen, wanted, memory_order_relaxed)) {
+                    shorter = distance < int(seen >> 32);
+                    break;
+                }
+            }
+            if (shorter)
+                buckets[t][size_t(distance / delta) % ring].push_back(v);
+        });
+    };
+    // Every thread takes chunks of items until they run out, then waits for the others.
+    auto share = [&](unsigned t, const vector<int>& items, bool light) {
+        constexpr size_t CHUNK = 256;
+        for (size_t begin; (begin = next.fetch_add(CHUNK, memory_order_relaxed)) < items.size();)
+            for (size_t i = begin; i < min(items.size(), begin + CHUNK); i++)
+                relax(t, items[i], light);
+        sync.arrive_and_wait();
+    };
+    // Thread 0 only: moves the live entries of bucket `current` into frontier.
+    auto gather = [&]() {
+        frontier.clear();
+        round++;
+        for (auto& mine : buckets) {
+            vector<int>& slot = mine[current % ring];
+            for (int v : slot)
+                if (round_mark[v] != round && size_t(distance_of(v) / delta) == current) {
+                    round_mark[v] = round;
+                    frontier.push_back(v);
+                    if (settled_mark[v] != current + 1) {
+                        settled_mark[v] = current + 1;
+                        settled.push_back(v);
+                    }
+                }
+            slot.clear();
+        }
+        next.store(0, memory_order_relaxed);
+    };
+
+    parallel_for(threads, [&](unsigned t) {
+        for (;;) {
+            if (t == 0) {
+                size_t skipped = 0;
+                while (skipped < ring && all_of(buckets.begin(), buckets.end(), [&](auto& mine) {
+                           return mine[current % ring].empty();
+                       })) {
+                    current++;
+                    skipped++;
+                }
+                done = skipped == ring;
+                settled.clear();
+            }
+            sync.arrive_and_wait();
+            if (done)
+                break;
+            for (;;) {
+                if (t == 0) {
+                    gather();
+                    bucket_done = frontier.empty();
+                }
+                sync.arrive_and_wait();
+                if (bucket_done)
+                    break;
+                share(t, frontier, true);
+            }
+            if (t == 0)
+                next.store(0, memory_order_relaxed);
+            sync.arrive_and_wait();
+            share(t, settled, false);
+            if (t == 0)
+                current++;
+        }
+    });
+
+    vector<int> distances(n);
+    previous.resize(n);
+    for (int v = 0; v < n; v++) {
+        uint64_t packed = label[v].load(memory_order_relaxed);
+        distances[v] = int(packed >> 32);
+        previous[v] = int(uint32_t(packed));
+    }
     return distances;
 }
 
+vector<int> delta_stepping_shortest_path(const Graph& G, int source, vector<int>& previous, unsigned threads,
+                                         int delta) {
+    return delta_stepping(G, source, previous, threads, delta);
+}
+
+vector<int> delta_stepping_shortest_path(const CsrGraph& G, int source, vector<int>& previous, unsigned threads,
+                                         int delta) {
+    return delta_stepping(G, source, previous, threads, delta);
+}
+
+DynamicShortestPaths::DynamicShortestPaths(const Graph& G, int source) : G(G), in(G.numVertices), root(source) {
+    if (source < 0 || source >= G.numVertices)
+        throw runtime_error("Source vertex out of range");
+    for (int u = 0; u < G.numVertices; u++)
+        for (const Edge& e : G[u])
+            in[e.dst].push_back(e);
+    dist = dijkstra_shortest_path<BinaryHeapQueue>(G, source, prev);
+    affected.assign(G.numVertices, false);
+}
+
+void DynamicShortestPaths::check_endpoints(int src, int dst) const {
+    if (src < 0 || src >= G.numVertices || dst < 0 || dst >= G.numVertices)
+        throw runtime_error("Edge endpoint out of range");
+}
+
+void DynamicShortestPaths::insert_edge(const Edge& e) {
+    check_endpoints(e.src, e.dst);
+    G[e.src].push_back(e);
+    in[e.dst].push_back(e);
+    repair(e.src, e.dst);
+}
+
+int DynamicShortestPaths::delete_edge(int src, int dst) {
+    check_endpoints(src, dst);
+    auto goes_to = [&](const Edge& e) { return e.src == src && e.dst == dst; };
+    int removed = erase_if(G[src], goes_to);
+    erase_if(in[dst], goes_to);
+    touched = 0;
+    if (removed)
+        repair(src, dst);
+    return removed;
+}
+
+void DynamicShortestPaths::set_weight(int src, int dst, int weight) {
+    check_endpoints(src, dst);
+    bool found = false;
+    for (Edge& e : G[src])
+        if (e.dst == dst) {
+            e.weight = weight;
+            found = true;
+        }
+    if (!found)
+        throw runtime_error("No such edge");
+    for (Edge& e : in[dst])
+        if (e.src == src)
+            e.weight = weight;
+    repair(src, dst);
+}
+
+// Weight of the lightest edge src -> dst, or INF if there is none.
+int DynamicShortestPaths::lightest(int src, int dst) const {
+    int best = INF;
+    for (const Edge& e : G[src])
+        if (e.dst == dst)
+            best = min(best, e.weight);
+    return best;
+}
+
+/*
+  Only the edges u -> v changed, so only v's label can be wrong directly. If they now offer
+  v a shorter route, improvements spread from v. If they offer an equally short one from a
+  smaller u, only previous[v] changes. If v's tree edge came from u and is no longer tight,
+  v and its subtree lose their paths and are recomputed. Otherwise nothing changes.
+*/
+void DynamicShortestPaths::repair(int u, int v) {
+    touched = 0;
+    int weight = lightest(u, v);
+    int distance = dist[u] == INF || weight == INF ? INF : dist[u] + weight;
+    if (distance < dist[v])
+        propagate_decrease(u, v, distance);
+    else if (distance == dist[v] && distance != INF && u < prev[v])
+        prev[v] = u;
+    else if (prev[v] == u && distance != dist[v])
+        recompute_subtree(v);
+}
+
+void DynamicShortestPaths::propagate_decrease(int u, int v, int distance) {
+    dist[v] = distance;
+    prev[v] = u;
+    pq.push(Node(v, distance));
+    while (!pq.empty()) {
+        Node current = pq.top();
+        pq.pop();
+        int x = current.vertex;
+        if (current.distance != dist[x])
+            continue;
+        touched++;
+        for (const Edge& e : G[x]) {
+            int candidate = dist[x] + e.weight;
+            if (candidate < dist[e.dst]) {
+                dist[e.dst] = candidate;
+                prev[e.dst] = x;
+                pq.push(Node(e.dst, candidate));
+            } else if (candidate == dist[e.dst] && x < prev[e.dst]) {
+                prev[e.dst] = x;
+            }
+        }
+    }
+}
+
+/*
+  Every vertex below v in the previous tree may have lost its path. Each one restarts from
+  its best edge out of the unaffected part of the graph, whose distances are still exact,
+  and a Dijkstra over the subtree alone settles the rest.
+*/
+void DynamicShortestPaths::recompute_subtree(int v) {
+    subtree.assign(1, v);
+    affected[v] = true;
+    for (size_t i = 0; i < subtree.size(); i++)
+        for (const Edge& e : G[subtree[i]])
+            if (!affected[e.dst] && prev[e.dst] == subtree[i]) {
+                affected[e.dst] = true;
+                subtree.push_back(e.dst);
+            }
+
+    for (int x : subtree) {
+        dist[x] = INF;
+        prev[x] = -1;
+        for (const Edge& e : in[x]) {
+            if (affected[e.src] || dist[e.src] == INF)
+                continue;
+            int candidate = dist[e.src] + e.weight;
+            if (candidate < dist[x] || (candidate == dist[x] && e.src < prev[x])) {
+                dist[x] = candidate;
+                prev[x] = e.src;
+            }
+        }
+        if (dist[x] != INF)
+            pq.push(Node(x, dist[x]));
+    }
+    while (!pq.empty()) {
+        Node current = pq.top();
+        pq.pop();
+        int x = current.vertex;
+        if (current.distance != dist[x])
+            continue;
+        for (const Edge& e : G[x]) {
+            if (!affected[e.dst])
+                continue;
+            int candidate = dist[x] + e.weight;
+            if (candidate < dist[e.dst]) {
+                dist[e.dst] = candidate;
+                prev[e.dst] = x;
+                pq.push(Node(e.dst, candidate));
+            } else if (candidate == dist[e.dst] && x < prev[e.dst]) {
+                prev[e.dst] = x;
+            }
+        }
+    }
+    touched = subtree.size();
+    for (int x : subtree)
+        affected[x] = false;
+}
+
 vector<int> extract_shortest_path(const vector<int>& distances, const vector<int>& previous, int destination) {
+    TRACE_PHASE("reconstruction");
     vector<int> path;
     if (distances[destination] == INF) {
         return path;
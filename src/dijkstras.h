@@ -4,6 +4,9 @@
 #include <queue>
 #include <limits>
 #include <stack>
+#include <span>
+#include <functional>
+#include "dijkstra_queues.h"
 
 using namespace std;
 
@@ -47,6 +50,151 @@ inline void file_to_graph(const string& filename, Graph& G) {
     in.close();
 }
 
+// Compressed sparse row form of a Graph: the edges leaving u are dst[k], weight[k] for
+// k in [offsets[u], offsets[u + 1]), in the order they appear in the input file.
+struct CsrGraph {
+    int numVertices=0;
+    vector<int> offsets;
+    vector<int> dst;
+    vector<int> weight;
+
+    int numEdges() const { return dst.size(); }
+};
+
+// Bulk loader for the file_to_graph format: maps the file, counts tokens, then parses
+// them with from_chars straight into preallocated arrays, splitting both passes across
+// threads. Throws runtime_error on unreadable or malformed input.
+void file_to_graph(const string& filename, CsrGraph& G, unsigned threads = 1);
+
+// Among equally short routes into a vertex, previous keeps the smallest predecessor, so the
+// order in which the queue pops ties never matters.
+vector<int> dijkstra_shortest_path(const Graph& G, int source, vector<int>& previous);
+vector<int> dijkstra_shortest_path(const CsrGraph& G, int source, vector<int>& previous);
+
+// Queue is one of the policies in dijkstra_queues.h. Every policy yields the same distances
+// as above and, with positive weights, the same previous, so extract_shortest_path gives
+// the same paths whichever queue runs.
+template <typename Queue>
 vector<int> dijkstra_shortest_path(const Graph& G, int source, vector<int>& previous);
+template <typename Queue>
+vector<int> dijkstra_shortest_path(const CsrGraph& G, int source, vector<int>& previous);
+
+enum class DijkstraQueue { binary_heap, dary_heap, radix_heap, dial };
+const char* queue_name(DijkstraQueue queue);
+
+// Runs the search with the given policy; dial falls back to radix_heap (same result) when an
+// edge weighs more than DIAL_MAX_WEIGHT.
+vector<int> dijkstra_shortest_path(const Graph& G, int source, vector<int>& previous, DijkstraQueue queue);
+vector<int> dijkstra_shortest_path(const CsrGraph& G, int source, vector<int>& previous, DijkstraQueue queue);
+
+// Times a search from source with every queue policy and returns the fastest. Dial is
+// only tried when no edge weighs more than DIAL_MAX_WEIGHT.
+DijkstraQueue fastest_queue(const Graph& G, int source = 0);
+DijkstraQueue fastest_queue(const CsrGraph& G, int source = 0);
+
+// Point-to-point query: stops as soon as target is settled. The distances of settled vertices
+// (target included) and the previous chain back from target are the same as a full
+// dijkstra_shortest_path run, so extract_shortest_path(distances, previous, target) agrees.
+vector<int> dijkstra_point_to_point(const Graph& G, int source, int target, vector<int>& previous);
+vector<int> dijkstra_point_to_point(const CsrGraph& G, int source, int target, vector<int>& previous);
+
+// Landmark (ALT) lower bounds for A* queries: exact distances from and to a few landmark
+// vertices, stored vertex-major, computed once per graph. By the triangle inequality
+// lower_bound(v, t) <= d(v, t), or it is INF when v provably cannot reach t.
+struct AltLandmarks {
+    vector<int> landmarks;
+    vector<int> from;   // from[v * landmarks.size() + i] = d(landmarks[i], v)
+    vector<int> to;     // to[v * landmarks.size() + i] = d(v, landmarks[i])
+
+    int lower_bound(int v, int target) const;
+};
+
+AltLandmarks build_landmarks(const Graph& G, int count);
+AltLandmarks build_landmarks(const CsrGraph& G, int count);
+
+// A* from source to target guided by L. distances[target] is exact and previous traces a
+// shortest path to it; on ties that path may differ from dijkstra_point_to_point's.
+vector<int> alt_shortest_path(const Graph& G, const AltLandmarks& L, int source, int target, vector<int>& previous);
+vector<int> alt_shortest_path(const CsrGraph& G, const AltLandmarks& L, int source, int target, vector<int>& previous);
+
+// Distances from many sources at once. Sources run in parallel on `threads` threads (0: one
+// per core), each thread reusing one search workspace for all the sources it takes. Rows
+// are exactly what dijkstra_shortest_path returns for each source.
+//
+// Matrix form: matrix is preallocated row-major, sources.size() rows of numVertices entries,
+// row i holding the distances from sources[i]. Throws runtime_error on a size mismatch or a
+// source out of range.
+void multi_source_distances(const Graph& G, const vector<int>& sources, span<int> matrix,
+                            unsigned threads = 0, DijkstraQueue queue = DijkstraQueue::binary_heap);
+void multi_source_distances(const CsrGraph& G, const vector<int>& sources, span<int> matrix,
+                            unsigned threads = 0, DijkstraQueue queue = DijkstraQueue::binary_heap);
+
+// Streaming form, for when the full table does not fit in memory: sink(i, row) receives the
+// distances from sources[i] as soon as they are ready, in completion order. Calls are
+// serialized, and row is only valid during the call.
+using DistanceRowSink = function<void(size_t index, span<const int> row)>;
+void multi_source_distances(const Graph& G, const vector<int>& sources, const DistanceRowSink& sink,
+                            unsigned threads = 0, DijkstraQueue queue = DijkstraQueue::binary_heap);
+void multi_source_distances(const CsrGraph& G, const vector<int>& sources, const DistanceRowSink& sink,
+                            unsigned threads = 0, DijkstraQueue queue = DijkstraQueue::binary_heap);
+
+// The numVertices x numVertices row-major table of all shortest distances.
+vector<int> all_pairs_distances(const Graph& G, unsigned threads = 0, DijkstraQueue queue = DijkstraQueue::binary_heap);
+vector<int> all_pairs_distances(const CsrGraph& G, unsigned threads = 0,
+                                DijkstraQueue queue = DijkstraQueue::binary_heap);
+
+// Parallel single-source search by delta-stepping on `threads` threads (0: one per core),
+// with buckets of width delta (0: picked from the weights and average degree; widened when
+// the largest weight spans more than 65534 buckets, which bounds the bucket array). distances
+// equal dijkstra_shortest_path's, and with positive weights previous is the smallest tight
+// predecessor, as with the queue policies above. With zero-weight edges previous is still a
+// valid shortest-path tree, though it may pick other tied predecessors. Throws runtime_error
+// if source is out of range.
+vector<int> delta_stepping_shortest_path(const Graph& G, int source, vector<int>& previous, unsigned threads = 0,
+                                         int delta = 0);
+vector<int> delta_stepping_shortest_path(const CsrGraph& G, int source, vector<int>& previous, unsigned threads = 0,
+                                         int delta = 0);
+
+// Shortest paths from one source, kept up to date as edges are inserted, deleted or
+// reweighted (weights are assumed positive). Each update repairs only the vertices it can
+// affect, in the style of Ramalingam and Reps: a shorter edge pushes improvements outward
+// from its head, and a longer or removed tree edge recomputes just the subtree below it.
+// distances() and previous() always equal what dijkstra_shortest_path<Queue> would return
+// on graph(), previous being the smallest tight predecessor.
+class DynamicShortestPaths {
+public:
+    DynamicShortestPaths(const Graph& G, int source);
+
+    const Graph& graph() const { return G; }
+    int source() const { return root; }
+    const vector<int>& distances() const { return dist; }
+    const vector<int>& previous() const { return prev; }
+    // Vertices whose label the last update recomputed or improved.
+    size_t last_update_size() const { return touched; }
+
+    void insert_edge(const Edge& e);
+    // Removes every edge src -> dst and returns how many there were.
+    int delete_edge(int src, int dst);
+    // Gives every edge src -> dst the new weight. Throws runtime_error if there is none.
+    // All three throw runtime_error for an endpoint out of range.
+    void set_weight(int src, int dst, int weight);
+
+private:
+    void check_endpoints(int src, int dst) const;
+    int lightest(int src, int dst) const;
+    void repair(int u, int v);
+    void propagate_decrease(int u, int v, int distance);
+    void recompute_subtree(int v);
+
+    Graph G;
+    vector<vector<Edge>> in;   // in[v]: the edges entering v
+    int root;
+    vector<int> dist, prev;
+    vector<char> affected;     // scratch for recompute_subtree, all false between updates
+    vector<int> subtree;
+    priority_queue<Node, vector<Node>, NodeCompare> pq;
+    size_t touched = 0;
+};
+
 vector<int> extract_shortest_path(const vector<int>& /*distances*/, const vector<int>& previous, int destination);
 void print_path(const vector<int>& v, int total);
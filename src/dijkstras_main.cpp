@@ -0,0 +1,13 @@
+#include "dijkstras.h"
+
+int main(int argc, char* argv[]) {
+    string filename = argc > 1 ? argv[1] : "small.txt";
+    Graph G;
+    file_to_graph(filename, G);
+
+    vector<int> previous;
+    vector<int> distances = dijkstra_shortest_path(G, 0, previous);
+    for (int v = 0; v < G.numVertices; ++v)
+        print_path(extract_shortest_path(distances, previous, v), distances[v]);
+    return 0;
+}
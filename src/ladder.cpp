@@ -1,4 +1,5 @@
 #include "ladder.h"
+#include "search_trace.h"
 #include <iostream>
 #include <fstream>
 #include <queue>
@@ -8,6 +9,15 @@
 #include <cmath>
 #include <algorithm>
 #include <map>
+#include <unordered_map>
+#include <cstdint>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 using namespace std;
 
@@ -15,32 +25,124 @@ void error(string word1, string word2, string msg) {
     cerr << "Error: " << msg << " (" << word1 << ", " << word2 << ")" << endl;
 }
 
+// d == 1: one mismatch for equal lengths, otherwise the tails after the first mismatch must
+// line up once the extra character of the longer word is skipped.
+static bool within_one_edit(const string& str1, const string& str2) {
+    const string &shorter = str1.size() <= str2.size() ? str1 : str2;
+    const string &longer = str1.size() <= str2.size() ? str2 : str1;
+    size_t i = 0;
+    while (i < shorter.size() && shorter[i] == longer[i])
+        i++;
+    if (shorter.size() == longer.size())
+        return i == shorter.size() || shorter.compare(i + 1, string::npos, longer, i + 1) == 0;
+    return shorter.compare(i, string::npos, longer, i + 1) == 0;
+}
+
+/*
+  Banded edit distance:
+  Only cells with |i - j| <= d can hold a value <= d, so each row keeps just the 2d+1 cells of
+  that diagonal band (band index k = j - i + d) and values are capped at d+1. Two rows live in
+  a stack buffer, or a per-thread buffer for very large d, so no call allocates on the heap
+  once that buffer has grown.
+*/
 bool edit_distance_within(const string& str1, const string& str2, int d) {
     int m = str1.size();
     int n = str2.size();
 
     if (abs(m - n) > d) return false;
+    if (d == 0) return str1 == str2;
+    if (d == 1) return within_one_edit(str1, str2);
+    d = min(d, max(m, n));
 
-    vector<vector<int>> dp(m + 1, vector<int>(n + 1, 0));
-
-    for (int i = 0; i <= m; i++) {
-        dp[i][0] = i;
-    }
-    for (int j = 0; j <= n; j++) {
-        dp[0][j] = j;
+    constexpr int STACK_BAND = 64;
+    int width = 2 * d + 1;
+    int stack_rows[2 * STACK_BAND];
+    thread_local vector<int> heap_rows;
+    int *prev = stack_rows;
+    if (width > STACK_BAND) {
+        if (int(heap_rows.size()) < 2 * width)
+            heap_rows.resize(2 * width);
+        prev = heap_rows.data();
     }
+    int *cur = prev + width;
+    const int cap = d + 1;
 
+    for (int k = 0; k < width; k++) {
+        int j = k - d;
+        prev[k] = j < 0 || j > n ? cap : j;
+    }
     for (int i = 1; i <= m; i++) {
-        for (int j = 1; j <= n; j++) {
-            if (str1[i - 1] == str2[j - 1])
-                dp[i][j] = dp[i - 1][j - 1];
-            else
-                dp[i][j] = 1 + min({ dp[i - 1][j], dp[i][j - 1], dp[i - 1][j - 1] });
+        int row_min = cap;
+        for (int k = 0; k < width; k++) {
+            int j = i - d + k;
+            int value;
+            if (j < 0 || j > n) {
+                value = cap;
+            } else if (j == 0) {
+                value = min(i, cap);
+            } else if (str1[i - 1] == str2[j - 1]) {
+                value = prev[k];
+            } else {
+                int up = k + 1 < width ? prev[k + 1] : cap;
+                int left = k > 0 ? cur[k - 1] : cap;
+                value = min(1 + min({ up, left, prev[k] }), cap);
+            }
+            cur[k] = value;
+            row_min = min(row_min, value);
         }
-        int row_min = *min_element(dp[i].begin(), dp[i].end());
         if (row_min > d) return false;
+        swap(prev, cur);
+    }
+    return prev[n - m + d] <= d;
+}
+
+/*
+  Bit-parallel bulk filter (Myers, with Hyyro's global edit distance variant):
+  The word's per-character match masks are built once; each candidate then advances a whole
+  DP column of up to 64 rows per character with a handful of word operations, tracking only
+  the bottom-row score. Words longer than 64 characters use the banded kernel instead.
+*/
+vector<int> edit_distance_filter(const string& word, const vector<string>& candidates, int d) {
+    vector<int> within;
+    int m = word.size();
+    if (m == 0 || m > 64) {
+        for (size_t c = 0; c < candidates.size(); c++)
+            if (edit_distance_within(word, candidates[c], d))
+                within.push_back(c);
+        return within;
+    }
+
+    uint64_t peq[256] = {};
+    for (int i = 0; i < m; i++)
+        peq[static_cast<unsigned char>(word[i])] |= uint64_t(1) << i;
+    const uint64_t all = m == 64 ? ~uint64_t(0) : (uint64_t(1) << m) - 1;
+    const uint64_t last = uint64_t(1) << (m - 1);
+
+    for (size_t c = 0; c < candidates.size(); c++) {
+        const string &text = candidates[c];
+        int n = text.size();
+        if (abs(m - n) > d) continue;
+        uint64_t pv = all, mv = 0;
+        int score = m;
+        for (int j = 0; j < n; j++) {
+            uint64_t eq = peq[static_cast<unsigned char>(text[j])];
+            uint64_t xv = eq | mv;
+            uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+            uint64_t ph = mv | ~(xh | pv);
+            uint64_t mh = pv & xh;
+            if (ph & last) score++;
+            else if (mh & last) score--;
+            ph = (ph << 1) | 1;
+            mh <<= 1;
+            pv = (mh | ~(xv | ph)) & all;
+            mv = ph & xv & all;
+            // The bottom-row score drops by at most one per remaining character.
+            if (score - (n - 1 - j) > d) break;
+        }
+        if (score <= d)
+            within.push_back(c);
     }
-    return dp[m][n] <= d;
+    return within;
 }
 
 // With this implementation, two identical words are considered adjacent 
@@ -52,41 +154,52 @@ bool is_adjacent(const string& word1, const string& word2) {
 /*
   Helper function: get_neighbors
   Generates all candidate words that are one edit away (by substitution, insertion, or deletion)
-  from the input word.
+  from the input word. This variant overwrites the strings at the front of neighbors and
+  returns how many it wrote; later entries are left over from earlier calls, so a buffer
+  reused across calls keeps both its own capacity and that of its strings.
 */
-vector<string> get_neighbors(const string &word) {
-    vector<string> neighbors;
-    string candidate;
+static size_t get_neighbors(string_view word, vector<string>& neighbors) {
+    size_t count = 0;
+    auto next = [&]() -> string& {
+        if (count == neighbors.size())
+            neighbors.emplace_back();
+        return neighbors[count++];
+    };
     int len = word.size();
-    
+
     // Substitution: for each position, try each letter from 'a' to 'z'
     for (int i = 0; i < len; i++) {
-        candidate = word;
         for (char c = 'a'; c <= 'z'; c++) {
-            if (candidate[i] == c) continue;
+            if (word[i] == c) continue;
+            string &candidate = next();
+            candidate.assign(word);
             candidate[i] = c;
-            neighbors.push_back(candidate);
         }
     }
-    
+
     // Insertion: for each position from 0 to len, insert a letter
     for (int i = 0; i <= len; i++) {
         for (char c = 'a'; c <= 'z'; c++) {
-            candidate = word;
-            candidate.insert(candidate.begin() + i, c);
-            neighbors.push_back(candidate);
+            string &candidate = next();
+            candidate.assign(word.substr(0, i));
+            candidate += c;
+            candidate.append(word.substr(i));
         }
     }
-    
-    // Deletion: for each position, remove that letter (if word is non-empty)
-    if (len > 0) {
-        for (int i = 0; i < len; i++) {
-            candidate = word;
-            candidate.erase(candidate.begin() + i);
-            neighbors.push_back(candidate);
-        }
+
+    // Deletion: for each position, remove that letter
+    for (int i = 0; i < len; i++) {
+        string &candidate = next();
+        candidate.assign(word.substr(0, i));
+        candidate.append(word.substr(i + 1));
     }
-    
+
+    return count;
+}
+
+vector<string> get_neighbors(const string &word) {
+    vector<string> neighbors;
+    get_neighbors(word, neighbors);
     return neighbors;
 }
 
@@ -95,60 +208,775 @@ vector<string> get_neighbors(const string &word) {
   We partition the dictionary by word length, then use the get_neighbors helper to generate
   all candidate words one edit away from the current word. For each candidate, we check whether 
   it exists in our dictionary partition. Valid candidates are collected and sorted lexicographically
-  before being enqueued.
+  before being enqueued. The queue holds one LadderNode per visited word (a view of the word and
+  the index of the node it was reached from), and the ladder is rebuilt from those parent
+  indices only once end_word is reached. The queue and the candidate buffers are sized up front
+  from the dictionary, so past the partition a query allocates only the returned ladder.
 */
+struct LadderNode {
+    string_view word;
+    int parent;
+};
+
 vector<string> generate_word_ladder(const string& begin_word, const string& end_word, const set<string>& original_word_list) {
     if (begin_word == end_word) {
         error(begin_word, end_word, "Start and end words are the same");
         return vector<string>();
     }
     
-    // Partition the dictionary by word length.
-    map<int, set<string>> remaining_by_length;
-    for (const auto &word : original_word_list) {
-        remaining_by_length[word.size()].insert(word);
+    // Partition the dictionary by word length; the views point into original_word_list.
+    map<int, set<string_view>> remaining_by_length;
+    {
+        TRACE_PHASE("partition");
+        for (const auto &word : original_word_list) {
+            remaining_by_length[word.size()].insert(word);
+        }
+        // Remove the begin word from the appropriate group if present.
+        remaining_by_length[begin_word.size()].erase(begin_word);
     }
-    // Remove the begin word from the appropriate group if present.
-    remaining_by_length[begin_word.size()].erase(begin_word);
-    
-    queue<vector<string>> ladder_queue;
-    vector<string> start = {begin_word};
-    ladder_queue.push(start);
-    
-    while (!ladder_queue.empty()) {
-        vector<string> ladder = ladder_queue.front();
-        ladder_queue.pop();
-        string last_word = ladder.back();
-        
+
+    TRACE_PHASE("search");
+    // Every word is enqueued at most once, and no expanded word is longer than the longest
+    // dictionary word (or begin_word), which bounds its 52 * length + 26 candidates.
+    size_t longest = max(begin_word.size(), size_t(remaining_by_length.rbegin()->first));
+    vector<LadderNode> nodes;
+    nodes.reserve(original_word_list.size() + 1);
+    nodes.push_back({begin_word, -1});
+    vector<string> candidates;
+    candidates.reserve(52 * longest + 26);
+    vector<string_view> valid_neighbors;
+    valid_neighbors.reserve(52 * longest + 26);
+    for (size_t head = 0; head < nodes.size(); head++) {
+        TRACE_ADD(nodes_expanded, 1);
+        TRACE_MAX(peak_queue, nodes.size() - head);
         // Generate all candidate neighbors (one edit away).
-        vector<string> candidates = get_neighbors(last_word);
+        size_t count = get_neighbors(nodes[head].word, candidates);
+        TRACE_ADD(candidates_generated, count);
         // Collect valid neighbors (those in our dictionary) in a vector.
-        vector<string> valid_neighbors;
-        for (const string &candidate : candidates) {
-            int candidate_len = candidate.size();
-            if (remaining_by_length.count(candidate_len) &&
-                remaining_by_length[candidate_len].find(candidate) != remaining_by_length[candidate_len].end()) {
-                valid_neighbors.push_back(candidate);
+        valid_neighbors.clear();
+        for (size_t k = 0; k < count; k++) {
+            const string &candidate = candidates[k];
+            TRACE_ADD(dictionary_probes, 1);
+            auto group = remaining_by_length.find(candidate.size());
+            if (group == remaining_by_length.end()) continue;
+            auto found = group->second.find(candidate);
+            if (found != group->second.end()) {
+                valid_neighbors.push_back(*found);
             }
         }
         // Sort valid neighbors lexicographically.
         sort(valid_neighbors.begin(), valid_neighbors.end());
         
-        // Enqueue each valid neighbor.
-        for (const string &candidate : valid_neighbors) {
-            remaining_by_length[candidate.size()].erase(candidate);
-            vector<string> new_ladder = ladder;
-            new_ladder.push_back(candidate);
+        // Enqueue each valid neighbor; insertions can yield the same word twice.
+        for (string_view candidate : valid_neighbors) {
+            if (remaining_by_length[candidate.size()].erase(candidate) == 0) continue;
+            nodes.push_back({candidate, int(head)});
             if (candidate == end_word) {
-                return new_ladder;
+                TRACE_PHASE("reconstruction");
+                size_t steps = 0;
+                for (int i = nodes.size() - 1; i != -1; i = nodes[i].parent) {
+                    steps++;
+                }
+                vector<string> ladder;
+                ladder.reserve(steps);
+                for (int i = nodes.size() - 1; i != -1; i = nodes[i].parent) {
+                    ladder.emplace_back(nodes[i].word);
+                }
+                reverse(ladder.begin(), ladder.end());
+                return ladder;
             }
-            ladder_queue.push(new_ladder);
         }
     }
     error(begin_word, end_word, "No word ladder found");
     return vector<string>();
 }
 
+// get_neighbors only ever substitutes or inserts these letters.
+static bool is_ladder_letter(char c) {
+    return c >= 'a' && c <= 'z';
+}
+
+/*
+  WordGraph image layout (native byte order, every section 4-byte aligned):
+    WordImageHeader
+    int word_offsets[words + 1], length_offsets[max_length + 2], by_length[words]
+    int adj_offsets[words + 1], adj[edges], radj_offsets[words + 1], radj[edges]
+    char arena[arena_bytes]
+*/
+struct WordImageHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t words;
+    uint32_t arena_bytes;
+    uint32_t edges;
+    uint32_t max_length;
+    uint32_t reserved;
+};
+static_assert(sizeof(WordImageHeader) % sizeof(int) == 0 && sizeof(int) == 4);
+
+static constexpr char WORD_IMAGE_MAGIC[8] = {'H', 'W', '9', 'W', 'O', 'R', 'D', 'S'};
+static constexpr uint32_t WORD_IMAGE_VERSION = 1;
+
+// Points graph's views into a complete image, checking that its sections fit together.
+static void attach_image(WordGraph& graph, span<const char> image, shared_ptr<const void> storage) {
+    auto invalid = [] { throw runtime_error("Invalid word graph image"); };
+    WordImageHeader h;
+    if (image.size() < sizeof(h)) invalid();
+    memcpy(&h, image.data(), sizeof(h));
+    if (memcmp(h.magic, WORD_IMAGE_MAGIC, sizeof(h.magic)) != 0 || h.version != WORD_IMAGE_VERSION) invalid();
+
+    // Section sizes in 64 bits so that no header field can wrap them. No word is longer than
+    // the arena holding all of them, which bounds max_length before any span is formed.
+    uint64_t words = h.words, edges = h.edges, lengths = uint64_t(h.max_length) + 2;
+    if (h.max_length > h.arena_bytes) invalid();
+    uint64_t ints = 3 * (words + 1) + lengths + words + 2 * edges;
+    if (image.size() != sizeof(h) + 4 * ints + h.arena_bytes) invalid();
+    const int *p = reinterpret_cast<const int*>(image.data() + sizeof(h));
+    auto take = [&](uint64_t count) {
+        span<const int> section(p, count);
+        p += count;
+        return section;
+    };
+    graph.word_offsets = take(words + 1);
+    graph.length_offsets = take(lengths);
+    graph.by_length = take(words);
+    graph.adj_offsets = take(words + 1);
+    graph.adj = take(edges);
+    graph.radj_offsets = take(words + 1);
+    graph.radj = take(edges);
+    graph.arena = string_view(reinterpret_cast<const char*>(p), h.arena_bytes);
+    // One pass over the index arrays, so a damaged image is rejected here rather than read
+    // out of bounds by a later search: offsets run from 0 up to their section's size, and
+    // every stored id names a word.
+    auto check_offsets = [&](span<const int> offsets, uint32_t end) {
+        if (offsets.front() != 0 || uint32_t(offsets.back()) != end) invalid();
+        for (size_t i = 1; i < offsets.size(); i++)
+            if (offsets[i] < offsets[i - 1]) invalid();
+    };
+    auto check_ids = [&](span<const int> ids) {
+        for (int id : ids)
+            if (uint32_t(id) >= h.words) invalid();
+    };
+    check_offsets(graph.word_offsets, h.arena_bytes);
+    check_offsets(graph.length_offsets, h.words);
+    check_offsets(graph.adj_offsets, h.edges);
+    check_offsets(graph.radj_offsets, h.edges);
+    check_ids(graph.by_length);
+    check_ids(graph.adj);
+    check_ids(graph.radj);
+    graph.image = image;
+    graph.storage = std::move(storage);
+}
+
+// Lays the index arrays out as one image in an owned buffer and attaches graph to it.
+static void pack_image(WordGraph& graph, string_view arena, const vector<int>& word_offsets,
+                       const vector<int>& adj_offsets, const vector<int>& adj,
+                       const vector<int>& radj_offsets, const vector<int>& radj) {
+    int n = word_offsets.size() - 1;
+    int max_length = 0;
+    for (int id = 0; id < n; id++)
+        max_length = max(max_length, word_offsets[id + 1] - word_offsets[id]);
+    // Counting sort by length keeps ids ascending within each length.
+    vector<int> length_offsets(max_length + 2, 0), by_length(n);
+    for (int id = 0; id < n; id++)
+        length_offsets[word_offsets[id + 1] - word_offsets[id] + 1]++;
+    for (int len = 0; len <= max_length; len++)
+        length_offsets[len + 1] += length_offsets[len];
+    vector<int> next(length_offsets.begin(), length_offsets.end() - 1);
+    for (int id = 0; id < n; id++)
+        by_length[next[word_offsets[id + 1] - word_offsets[id]]++] = id;
+
+    WordImageHeader h = {};
+    memcpy(h.magic, WORD_IMAGE_MAGIC, sizeof(h.magic));
+    h.version = WORD_IMAGE_VERSION;
+    h.words = n;
+    h.arena_bytes = arena.size();
+    h.edges = adj.size();
+    h.max_length = max_length;
+
+    size_t ints = sizeof(h) / 4 + word_offsets.size() + length_offsets.size() + by_length.size() +
+                  adj_offsets.size() + adj.size() + radj_offsets.size() + radj.size();
+    auto buffer = make_shared<vector<int>>(ints + (arena.size() + 3) / 4);
+    char *out = reinterpret_cast<char*>(buffer->data());
+    auto put = [&](const void* data, size_t bytes) {
+        if (bytes) memcpy(out, data, bytes);
+        out += bytes;
+    };
+    put(&h, sizeof(h));
+    for (const vector<int> *section : initializer_list<const vector<int>*>{
+             &word_offsets, &length_offsets, &by_length, &adj_offsets, &adj, &radj_offsets, &radj})
+        put(section->data(), section->size() * sizeof(int));
+    put(arena.data(), arena.size());
+    size_t bytes = out - reinterpret_cast<char*>(buffer->data());
+    attach_image(graph, span<const char>(reinterpret_cast<const char*>(buffer->data()), bytes), buffer);
+}
+
+/*
+  WordGraph construction:
+  Substitution edges come from wildcard buckets: words of equal length that agree everywhere
+  except position i share the key "word with position i blanked". Insertion and deletion edges
+  come from looking up every one-character deletion of each word; a hit gives a deletion edge
+  from the longer word and, when the removed character is a letter, an insertion edge back.
+  The words are packed first so that word() and find() work while the edges are collected.
+*/
+WordGraph::WordGraph(const set<string>& word_list) {
+    TRACE_PHASE("partition");
+    string words;
+    vector<int> offsets = {0};
+    offsets.reserve(word_list.size() + 1);
+    for (const string &w : word_list) {
+        words += w;
+        offsets.push_back(words.size());
+    }
+    int n = offsets.size() - 1;
+    pack_image(*this, words, offsets, vector<int>(n + 1, 0), {}, vector<int>(n + 1, 0), {});
+    vector<vector<int>> out(n);
+
+    unordered_map<string, vector<int>> buckets;
+    for (int id = 0; id < n; id++) {
+        string key(word(id));
+        for (size_t i = 0; i < key.size(); i++) {
+            char saved = key[i];
+            key[i] = '\0';
+            buckets[key].push_back(id);
+            key[i] = saved;
+        }
+    }
+    for (const auto &[key, ids] : buckets) {
+        size_t i = key.find('\0');
+        for (int a : ids)
+            for (int b : ids)
+                if (a != b && is_ladder_letter(word(b)[i]))
+                    out[a].push_back(b);
+    }
+
+    for (int id = 0; id < n; id++) {
+        string_view w = word(id);
+        for (size_t k = 0; k < w.size(); k++) {
+            string shorter(w.substr(0, k));
+            shorter += w.substr(k + 1);
+            int t = find(shorter);
+            if (t < 0) continue;
+            out[id].push_back(t);
+            if (is_ladder_letter(w[k]))
+                out[t].push_back(id);
+        }
+    }
+
+    vector<int> adj_offsets = {0}, adj, radj_offsets = {0}, radj;
+    vector<vector<int>> in(n);
+    for (int u = 0; u < n; u++) {
+        vector<int> &list = out[u];
+        sort(list.begin(), list.end());
+        list.erase(unique(list.begin(), list.end()), list.end());
+        adj.insert(adj.end(), list.begin(), list.end());
+        adj_offsets.push_back(adj.size());
+        for (int v : list)
+            in[v].push_back(u);   // u ascending, so each row stays sorted
+    }
+    for (const auto &list : in) {
+        radj.insert(radj.end(), list.begin(), list.end());
+        radj_offsets.push_back(radj.size());
+    }
+    pack_image(*this, words, offsets, adj_offsets, adj, radj_offsets, radj);
+}
+
+void save_word_graph(const WordGraph& graph, const string& file_name) {
+    ofstream out(file_name, ios::binary);
+    if (!out || !out.write(graph.image.data(), graph.image.size()))
+        throw runtime_error("Can't write word graph image");
+}
+
+WordGraph load_word_graph(const string& file_name) {
+    int fd = open(file_name.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw runtime_error("Can't open word graph image");
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        throw runtime_error("Invalid word graph image");
+    }
+    size_t bytes = st.st_size;
+    void *mapped = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED)
+        throw runtime_error("Can't map word graph image");
+    shared_ptr<const void> mapping(mapped, [bytes](const void* p) { munmap(const_cast<void*>(p), bytes); });
+
+    WordGraph graph;
+    attach_image(graph, span<const char>(static_cast<const char*>(mapped), bytes), std::move(mapping));
+    return graph;
+}
+
+int WordGraph::find(string_view w) const {
+    TRACE_ADD(dictionary_probes, 1);
+    int lo = 0, hi = size();
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (word(mid) < w)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo < size() && word(lo) == w ? lo : -1;
+}
+
+vector<int> WordGraph::neighbors_of(const string& w) const {
+    int id = find(w);
+    if (id >= 0) {
+        span<const int> list = neighbors(id);
+        return vector<int>(list.begin(), list.end());
+    }
+    // Words outside the dictionary have no precomputed row; probe their candidates once.
+    vector<int> ids;
+    vector<string> candidates = get_neighbors(w);
+    TRACE_ADD(candidates_generated, candidates.size());
+    for (const string &candidate : candidates) {
+        int c = find(candidate);
+        if (c >= 0) ids.push_back(c);
+    }
+    sort(ids.begin(), ids.end());
+    ids.erase(unique(ids.begin(), ids.end()), ids.end());
+    return ids;
+}
+
+// Sizes the workspace for graph. Every array is left cleared after a query, so this only
+// allocates the first time a workspace meets a dictionary of a new size.
+static void prepare_workspace(LadderWorkspace& ws, const WordGraph& graph) {
+    size_t n = graph.size();
+    if (ws.parent.size() == n) return;
+    ws.parent.assign(n, LadderWorkspace::UNVISITED);
+    ws.dist_f.assign(n, -1);
+    ws.dist_b.assign(n, -1);
+    ws.on_ladder.assign(n, 0);
+    for (vector<int> *list : {&ws.queue, &ws.levels_f, &ws.levels_b, &ws.level_start, &ws.ids}) {
+        list->clear();
+        list->reserve(n + 2);
+    }
+}
+
+static span<const int> begin_neighbors(const string& begin_word, int begin_id, const WordGraph& graph, LadderWorkspace& ws) {
+    if (begin_id >= 0)
+        return graph.neighbors(begin_id);
+    ws.begin_neighbors = graph.neighbors_of(begin_word);
+    return ws.begin_neighbors;
+}
+
+/*
+  Index-based forward search:
+  Same breadth-first order as the set-based version (ids are visited in sorted order), but
+  neighbors come straight from the precomputed adjacency and each visited word records only
+  the id it was reached from. parent[v] == -1 means v was reached from begin_word itself.
+  Leaves the ladder ids after begin_word in ws.ids (empty if end_id is unreachable).
+*/
+static void forward_ladder_ids(const string& begin_word, int end_id, const WordGraph& graph, LadderWorkspace& ws, LadderStats& stats) {
+    int begin_id = graph.find(begin_word);
+    if (begin_id >= 0)
+        ws.parent[begin_id] = -1;
+
+    auto visit = [&](int v, int from) {
+        if (ws.parent[v] != LadderWorkspace::UNVISITED) return false;
+        ws.parent[v] = from;
+        ws.queue.push_back(v);
+        return v == end_id;
+    };
+
+    bool found = false;
+    stats.nodes_expanded++;
+    TRACE_ADD(nodes_expanded, 1);
+    span<const int> first_rung = begin_neighbors(begin_word, begin_id, graph, ws);
+    TRACE_ADD(candidates_generated, first_rung.size());
+    for (int v : first_rung)
+        if ((found = visit(v, -1))) break;
+    for (size_t head = 0; !found && head < ws.queue.size(); head++) {
+        int u = ws.queue[head];
+        stats.nodes_expanded++;
+        TRACE_ADD(nodes_expanded, 1);
+        TRACE_MAX(peak_queue, ws.queue.size() - head);
+        TRACE_ADD(candidates_generated, graph.neighbors(u).size());
+        for (int v : graph.neighbors(u))
+            if ((found = visit(v, u))) break;
+    }
+    if (found) {
+        TRACE_PHASE("reconstruction");
+        for (int v = end_id; v != -1; v = ws.parent[v])
+            ws.ids.push_back(v);
+        reverse(ws.ids.begin(), ws.ids.end());
+    }
+
+    for (int v : ws.queue)
+        ws.parent[v] = LadderWorkspace::UNVISITED;
+    if (begin_id >= 0)
+        ws.parent[begin_id] = LadderWorkspace::UNVISITED;
+    ws.queue.clear();
+}
+
+/*
+  Index-based bidirectional search:
+  Expands whole BFS levels from whichever side has the smaller frontier, labelling forward
+  distances from begin_word and backward distances to end_word, until a level discovers a
+  word the other side has seen; that fixes the ladder length d = a + b. The forward BFS
+  returns the lexicographically smallest shortest ladder, so we rebuild that one greedily:
+  from each rung take the smallest neighbor that still lies on some shortest ladder. Past
+  the meeting level that is any neighbor one step closer to end_word; before it we first
+  prune the forward levels down to words that can reach the meeting level.
+*/
+static void bidirectional_ladder_ids(const string& begin_word, int end_id, const WordGraph& graph, LadderWorkspace& ws, LadderStats& stats) {
+    vector<int> &dist_f = ws.dist_f, &dist_b = ws.dist_b;
+    vector<int> &levels_f = ws.levels_f, &levels_b = ws.levels_b, &level_start = ws.level_start;
+    int begin_id = graph.find(begin_word);
+    span<const int> first_rung = begin_neighbors(begin_word, begin_id, graph, ws);
+
+    // levels_f holds every forward-labelled word, level by level; level_start[i] indexes it.
+    int a = 0;
+    if (begin_id >= 0) {
+        dist_f[begin_id] = 0;
+        level_start.push_back(0);
+        levels_f.push_back(begin_id);
+    } else {
+        // begin_word has no id, so its neighbors form the first labelled level.
+        stats.nodes_expanded++;
+        TRACE_ADD(nodes_expanded, 1);
+        TRACE_ADD(candidates_generated, first_rung.size());
+        a = 1;
+        level_start.assign(2, 0);
+        for (int v : first_rung) {
+            dist_f[v] = 1;
+            levels_f.push_back(v);
+        }
+    }
+    // levels_b holds every backward-labelled word; the current level starts at frontier_b.
+    dist_b[end_id] = 0;
+    levels_b.push_back(end_id);
+    size_t frontier_b = 0;
+    int b = 0;
+    bool met = begin_id < 0 && dist_f[end_id] == 1;
+
+    while (!met) {
+        size_t forward_size = levels_f.size() - level_start.back();
+        size_t backward_size = levels_b.size() - frontier_b;
+        if (forward_size == 0 || backward_size == 0)
+            break;
+        TRACE_MAX(peak_queue, min(forward_size, backward_size));
+        if (forward_size <= backward_size) {
+            size_t lo = level_start.back(), hi = levels_f.size();
+            level_start.push_back(hi);
+            for (size_t k = lo; k < hi; k++) {
+                stats.nodes_expanded++;
+                TRACE_ADD(nodes_expanded, 1);
+                TRACE_ADD(candidates_generated, graph.neighbors(levels_f[k]).size());
+                for (int v : graph.neighbors(levels_f[k])) {
+                    if (dist_f[v] != -1) continue;
+                    dist_f[v] = a + 1;
+                    levels_f.push_back(v);
+                    met = met || dist_b[v] != -1;
+                }
+            }
+            a++;
+        } else {
+            size_t lo = frontier_b, hi = levels_b.size();
+            frontier_b = hi;
+            for (size_t k = lo; k < hi; k++) {
+                stats.nodes_expanded++;
+                TRACE_ADD(nodes_expanded, 1);
+                TRACE_ADD(candidates_generated, graph.predecessors(levels_b[k]).size());
+                for (int v : graph.predecessors(levels_b[k])) {
+                    if (dist_b[v] != -1) continue;
+                    dist_b[v] = b + 1;
+                    levels_b.push_back(v);
+                    met = met || dist_f[v] != -1;
+                }
+            }
+            b++;
+        }
+    }
+
+    if (met) {
+        TRACE_PHASE("reconstruction");
+        int d = a + b;
+        // on_ladder[v]: forward level v reaches the meeting level within the shortest length.
+        for (size_t k = level_start[a]; k < levels_f.size(); k++)
+            ws.on_ladder[levels_f[k]] = dist_b[levels_f[k]] == b;
+        for (int i = a - 1; i >= 0; i--) {
+            for (size_t k = level_start[i]; k < size_t(level_start[i + 1]); k++) {
+                int u = levels_f[k];
+                for (int v : graph.neighbors(u))
+                    if (dist_f[v] == i + 1 && ws.on_ladder[v]) {
+                        ws.on_ladder[u] = 1;
+                        break;
+                    }
+            }
+        }
+
+        span<const int> candidates = first_rung;
+        for (int i = 1; i <= d; i++) {
+            int pick = -1;
+            for (int v : candidates) {
+                bool ok = i < a ? dist_f[v] == i && ws.on_ladder[v] : dist_b[v] == d - i;
+                if (ok) {
+                    pick = v;
+                    break;
+                }
+            }
+            ws.ids.push_back(pick);
+            candidates = graph.neighbors(pick);
+        }
+    }
+
+    for (int v : levels_f) {
+        dist_f[v] = -1;
+        ws.on_ladder[v] = 0;
+    }
+    for (int v : levels_b)
+        dist_b[v] = -1;
+    levels_f.clear();
+    levels_b.clear();
+    level_start.clear();
+}
+
+// Runs one WordGraph query into ladder; returns the error to report, or nullptr on success.
+static const char* find_ladder(const string& begin_word, const string& end_word, const WordGraph& graph,
+                               LadderWorkspace& workspace, LadderMode mode, LadderStats& stats, vector<string>& ladder) {
+    ladder.clear();
+    if (begin_word == end_word)
+        return "Start and end words are the same";
+    prepare_workspace(workspace, graph);
+    workspace.ids.clear();
+    TRACE_PHASE("search");
+    int end_id = graph.find(end_word);
+    if (end_id >= 0) {
+        if (mode == LadderMode::bidirectional)
+            bidirectional_ladder_ids(begin_word, end_id, graph, workspace, stats);
+        else
+            forward_ladder_ids(begin_word, end_id, graph, workspace, stats);
+    }
+    if (workspace.ids.empty())
+        return "No word ladder found";
+
+    ladder.reserve(workspace.ids.size() + 1);
+    ladder.push_back(begin_word);
+    for (int id : workspace.ids)
+        ladder.emplace_back(graph.word(id));
+    return nullptr;
+}
+
+vector<string> generate_word_ladder(const string& begin_word, const string& end_word, const WordGraph& graph,
+                                    LadderWorkspace& workspace, LadderMode mode, LadderStats* stats) {
+    LadderStats local;
+    vector<string> ladder;
+    if (const char *msg = find_ladder(begin_word, end_word, graph, workspace, mode, stats ? *stats : local, ladder))
+        error(begin_word, end_word, msg);
+    return ladder;
+}
+
+vector<string> generate_word_ladder(const string& begin_word, const string& end_word, const WordGraph& graph,
+                                    LadderMode mode, LadderStats* stats) {
+    LadderWorkspace workspace;
+    return generate_word_ladder(begin_word, end_word, graph, workspace, mode, stats);
+}
+
+/*
+  LadderEngine:
+  The calling thread acts as worker 0 and threads() - 1 pool threads sleep on the batch
+  generation counter between batches.
+  A batch is cut into one contiguous range per worker; a worker drains its own range first
+  and then steals single queries from the other ranges, so a few slow queries cannot leave
+  the rest of the pool idle. Each result lands in its query's slot and errors are reported
+  in query order after the batch, so the output never depends on scheduling.
+*/
+LadderEngine::LadderEngine(const WordGraph& graph, unsigned threads) : graph(graph) {
+    if (threads == 0)
+        threads = max(1u, thread::hardware_concurrency());
+    workspaces.resize(threads);
+    ranges.reset(new WorkRange[threads]);
+    for (unsigned w = 1; w < threads; w++)
+        workers.emplace_back(&LadderEngine::worker_loop, this, w);
+}
+
+LadderEngine::~LadderEngine() {
+    stopping = true;
+    generation++;
+    generation.notify_all();
+    for (thread &t : workers)
+        t.join();
+}
+
+void LadderEngine::worker_loop(unsigned w) {
+    unsigned seen = 0;
+    for (;;) {
+        generation.wait(seen);
+        if (stopping) return;
+        seen = generation;
+        run_share(w);
+        if (running.fetch_sub(1) == 1)
+            running.notify_one();
+    }
+}
+
+void LadderEngine::run_share(unsigned w) {
+    unsigned n = threads();
+    LadderStats stats;
+    for (unsigned k = 0; k < n; k++) {
+        WorkRange &range = ranges[(w + k) % n];
+        for (size_t i; (i = range.next.fetch_add(1)) < range.end;)
+            batch_errors[i] = find_ladder((*batch)[i].first, (*batch)[i].second, graph, workspaces[w],
+                                          batch_mode, stats, (*batch_results)[i]);
+    }
+}
+
+vector<vector<string>> LadderEngine::solve(const vector<pair<string, string>>& queries, LadderMode mode,
+                                           LadderBatchStats* stats) {
+    auto start = chrono::steady_clock::now();
+    vector<vector<string>> results(queries.size());
+    batch_errors.assign(queries.size(), nullptr);
+    unsigned n = threads();
+    for (unsigned w = 0; w < n; w++) {
+        ranges[w].next = queries.size() * w / n;
+        ranges[w].end = queries.size() * (w + 1) / n;
+    }
+    batch = &queries;
+    batch_mode = mode;
+    batch_results = &results;
+    running = workers.size();
+    generation++;
+    generation.notify_all();
+    run_share(0);
+    for (size_t left; (left = running) != 0;)
+        running.wait(left);
+
+    for (size_t i = 0; i < queries.size(); i++)
+        if (batch_errors[i])
+            error(queries[i].first, queries[i].second, batch_errors[i]);
+    if (stats) {
+        stats->queries = queries.size();
+        stats->threads = n;
+        stats->seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        stats->queries_per_second = stats->seconds > 0 ? queries.size() / stats->seconds : 0;
+    }
+    return results;
+}
+
+size_t LadderTree::memory_bytes() const {
+    return sizeof(LadderTree) + begin_word.capacity() + (parent.capacity() + distance.capacity()) * sizeof(int);
+}
+
+// forward_ladder_ids without the early exit: the BFS runs until the whole reachable part of
+// the graph is labelled. Parents are never overwritten, so every word keeps the parent that
+// the stopping search would have given it.
+LadderTree build_ladder_tree(const string& begin_word, const WordGraph& graph) {
+    TRACE_PHASE("search");
+    LadderTree tree;
+    tree.begin_word = begin_word;
+    tree.parent.assign(graph.size(), LadderWorkspace::UNVISITED);
+    tree.distance.assign(graph.size(), -1);
+    int begin_id = graph.find(begin_word);
+    if (begin_id >= 0) {
+        tree.parent[begin_id] = -1;
+        tree.distance[begin_id] = 0;
+    }
+
+    vector<int> queue;
+    auto visit = [&](int v, int from, int distance) {
+        if (tree.parent[v] != LadderWorkspace::UNVISITED) return;
+        tree.parent[v] = from;
+        tree.distance[v] = distance;
+        queue.push_back(v);
+    };
+    TRACE_ADD(nodes_expanded, 1);
+    for (int v : graph.neighbors_of(begin_word))
+        visit(v, -1, 1);
+    for (size_t head = 0; head < queue.size(); head++) {
+        int u = queue[head];
+        TRACE_ADD(nodes_expanded, 1);
+        TRACE_MAX(peak_queue, queue.size() - head);
+        TRACE_ADD(candidates_generated, graph.neighbors(u).size());
+        for (int v : graph.neighbors(u))
+            visit(v, u, tree.distance[u] + 1);
+    }
+    return tree;
+}
+
+vector<string> generate_word_ladder(const LadderTree& tree, const string& end_word, const WordGraph& graph) {
+    if (tree.begin_word == end_word) {
+        error(tree.begin_word, end_word, "Start and end words are the same");
+        return vector<string>();
+    }
+    int end_id = graph.find(end_word);
+    if (end_id < 0 || tree.distance[end_id] <= 0) {
+        error(tree.begin_word, end_word, "No word ladder found");
+        return vector<string>();
+    }
+    TRACE_PHASE("reconstruction");
+    vector<string> ladder(tree.distance[end_id] + 1);
+    ladder[0] = tree.begin_word;
+    for (int v = end_id, rung = tree.distance[end_id]; v != -1; v = tree.parent[v], rung--)
+        ladder[rung] = graph.word(v);
+    return ladder;
+}
+
+LadderTreeCache::LadderTreeCache(const WordGraph& graph, size_t memory_budget) : graph(graph), budget(memory_budget) {}
+
+/*
+  The tree is built outside the lock so that misses on different words do not wait for each
+  other. If two threads miss on the same word at once, both build it and the first to finish
+  is kept; the other's copy is still returned to its caller.
+*/
+shared_ptr<const LadderTree> LadderTreeCache::tree(const string& begin_word) {
+    {
+        lock_guard<mutex> guard(lock);
+        auto found = entries.find(begin_word);
+        if (found != entries.end()) {
+            hit_count++;
+            recent.splice(recent.begin(), recent, found->second);
+            return found->second->second;
+        }
+        miss_count++;
+    }
+
+    auto built = make_shared<const LadderTree>(build_ladder_tree(begin_word, graph));
+    size_t bytes = built->memory_bytes();
+    lock_guard<mutex> guard(lock);
+    if (bytes > budget || entries.count(begin_word))
+        return built;
+    while (used + bytes > budget) {
+        used -= recent.back().second->memory_bytes();
+        entries.erase(recent.back().first);
+        recent.pop_back();
+    }
+    recent.emplace_front(begin_word, built);
+    entries[begin_word] = recent.begin();
+    used += bytes;
+    return built;
+}
+
+vector<string> LadderTreeCache::ladder(const string& begin_word, const string& end_word) {
+    if (begin_word == end_word) {
+        error(begin_word, end_word, "Start and end words are the same");
+        return vector<string>();
+    }
+    return generate_word_ladder(*tree(begin_word), end_word, graph);
+}
+
+size_t LadderTreeCache::size() const {
+    lock_guard<mutex> guard(lock);
+    return entries.size();
+}
+
+size_t LadderTreeCache::memory_used() const {
+    lock_guard<mutex> guard(lock);
+    return used;
+}
+
+size_t LadderTreeCache::hits() const {
+    lock_guard<mutex> guard(lock);
+    return hit_count;
+}
+
+size_t LadderTreeCache::misses() const {
+    lock_guard<mutex> guard(lock);
+    return miss_count;
+}
+
 void load_words(set<string>& word_list, const string& file_name) {
     ifstream infile(file_name);
     if (!infile) {
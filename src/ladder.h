@@ -6,13 +6,186 @@
 #include <vector>
 #include <string>
 #include <cmath>
+#include <span>
+#include <string_view>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <list>
+#include <unordered_map>
+#include <mutex>
 
 using namespace std;
 
+// Read-only adjacency index over a load_words dictionary, built once and shared by
+// any number of ladder queries. Word ids are ranks in sorted order, so sorting ids
+// sorts words lexicographically. Edges follow get_neighbors: one substitution or
+// insertion of a letter 'a'..'z', or one deletion of any character.
+//
+// All arrays are views into one contiguous binary image, either built in memory or
+// mmapped from a file written by save_word_graph, so copies of a WordGraph are cheap
+// and share that image.
+struct WordGraph {
+    string_view arena;              // all words back to back
+    span<const int> word_offsets;   // size() + 1 offsets into arena
+    span<const int> length_offsets; // max word length + 2 offsets into by_length
+    span<const int> by_length;      // ids ordered by length, then id
+    span<const int> adj_offsets;    // size() + 1 offsets into adj
+    span<const int> adj;            // neighbor ids, sorted per word
+    span<const int> radj_offsets;   // size() + 1 offsets into radj
+    span<const int> radj;           // predecessor ids, sorted per word
+    span<const char> image;         // the whole image the views above point into
+    shared_ptr<const void> storage; // keeps image alive (owned buffer or mapping)
+
+    WordGraph() = default;
+    explicit WordGraph(const set<string>& word_list);
+
+    int size() const { return word_offsets.empty() ? 0 : int(word_offsets.size()) - 1; }
+    string_view word(int id) const {
+        return arena.substr(word_offsets[id], word_offsets[id + 1] - word_offsets[id]);
+    }
+    span<const int> neighbors(int id) const {
+        return adj.subspan(adj_offsets[id], adj_offsets[id + 1] - adj_offsets[id]);
+    }
+    span<const int> predecessors(int id) const {
+        return radj.subspan(radj_offsets[id], radj_offsets[id + 1] - radj_offsets[id]);
+    }
+    span<const int> words_of_length(size_t length) const {
+        if (length + 1 >= length_offsets.size()) return span<const int>();
+        return by_length.subspan(length_offsets[length], length_offsets[length + 1] - length_offsets[length]);
+    }
+    // Id of word, or -1 if it is not in the dictionary.
+    int find(string_view word) const;
+    // Sorted neighbor ids of an arbitrary word, which need not be in the dictionary.
+    vector<int> neighbors_of(const string& word) const;
+};
+
+// Writes graph's binary image so load_word_graph can map it instead of rebuilding it.
+void save_word_graph(const WordGraph& graph, const string& file_name);
+// Maps an image written by save_word_graph; the graph is usable with no parsing, after one
+// pass that checks its offsets and ids. Throws runtime_error for a damaged image.
+WordGraph load_word_graph(const string& file_name);
+
 void error(string word1, string word2, string msg);
 bool edit_distance_within(const std::string& str1, const std::string& str2, int d);
+// Indices of the candidates within edit distance d of word, checked in one bulk pass.
+vector<int> edit_distance_filter(const string& word, const vector<string>& candidates, int d);
 bool is_adjacent(const string& word1, const string& word2);
 vector<string> generate_word_ladder(const string& begin_word, const string& end_word, const set<string>& word_list);
+// forward grows one BFS from begin_word; bidirectional grows frontiers from both ends and
+// meets in the middle. Both return the same (lexicographically first shortest) ladder.
+enum class LadderMode { forward, bidirectional };
+
+struct LadderStats {
+    long long nodes_expanded = 0;
+};
+
+// Scratch state for WordGraph searches: per-word labels plus flat queues of ids. Arrays are
+// sized to the dictionary on first use and cleared again by each query, so reusing one
+// workspace makes a search allocate nothing beyond the returned ladder.
+struct LadderWorkspace {
+    static constexpr int UNVISITED = -2;
+    vector<int> parent;         // forward search; -1 means reached from begin_word
+    vector<int> dist_f, dist_b; // bidirectional search; -1 means unlabelled
+    vector<char> on_ladder;
+    vector<int> queue, levels_f, levels_b, level_start, begin_neighbors, ids;
+};
+
+vector<string> generate_word_ladder(const string& begin_word, const string& end_word, const WordGraph& graph,
+                                    LadderMode mode = LadderMode::forward, LadderStats* stats = nullptr);
+vector<string> generate_word_ladder(const string& begin_word, const string& end_word, const WordGraph& graph,
+                                    LadderWorkspace& workspace, LadderMode mode = LadderMode::forward,
+                                    LadderStats* stats = nullptr);
+struct LadderBatchStats {
+    size_t queries = 0;
+    unsigned threads = 0;
+    double seconds = 0;
+    double queries_per_second = 0;
+};
+
+// Solves batches of independent ladder queries in parallel against one shared WordGraph.
+// Every worker owns a LadderWorkspace that is reused across queries and batches, and the
+// results are exactly those of calling generate_word_ladder on each query in order.
+class LadderEngine {
+public:
+    explicit LadderEngine(const WordGraph& graph, unsigned threads = 0);   // 0: one per core
+    ~LadderEngine();
+    LadderEngine(const LadderEngine&) = delete;
+    LadderEngine& operator=(const LadderEngine&) = delete;
+
+    unsigned threads() const { return workspaces.size(); }
+    vector<vector<string>> solve(const vector<pair<string, string>>& queries,
+                                 LadderMode mode = LadderMode::forward, LadderBatchStats* stats = nullptr);
+
+private:
+    struct alignas(64) WorkRange {
+        atomic<size_t> next{0};
+        size_t end = 0;
+    };
+
+    void worker_loop(unsigned w);
+    void run_share(unsigned w);
+
+    const WordGraph& graph;
+    vector<LadderWorkspace> workspaces;
+    unique_ptr<WorkRange[]> ranges;
+    vector<thread> workers;
+
+    atomic<unsigned> generation{0};   // bumped to start a batch (or to stop)
+    atomic<size_t> running{0};        // pool threads still working on the batch
+    atomic<bool> stopping{false};
+    const vector<pair<string, string>>* batch = nullptr;
+    LadderMode batch_mode = LadderMode::forward;
+    vector<vector<string>>* batch_results = nullptr;
+    vector<const char*> batch_errors;
+};
+
+// Every ladder from one begin word: the full forward BFS tree over a WordGraph, built once.
+// parent[v] is the id v was first reached from (-1: from begin_word itself, UNVISITED: not
+// reachable) and distance[v] its number of steps from begin_word (-1: not reachable). The
+// expansion order is generate_word_ladder's, so the ladder read off the tree for any end
+// word is the same lexicographically first shortest ladder, in O(ladder length).
+struct LadderTree {
+    string begin_word;
+    vector<int> parent;
+    vector<int> distance;
+
+    size_t memory_bytes() const;
+};
+
+LadderTree build_ladder_tree(const string& begin_word, const WordGraph& graph);
+// The ladder from tree.begin_word to end_word; graph must be the one the tree was built on.
+// Reports the same errors as generate_word_ladder.
+vector<string> generate_word_ladder(const LadderTree& tree, const string& end_word, const WordGraph& graph);
+
+// Bounded LRU cache of LadderTrees keyed by begin word, for traffic where many queries share
+// a begin word. A miss builds the tree and evicts the least recently used ones until the
+// trees' memory_bytes() fit the budget; a tree larger than the whole budget is returned
+// but not kept. Safe to share between threads, and a returned tree stays valid while held.
+class LadderTreeCache {
+public:
+    LadderTreeCache(const WordGraph& graph, size_t memory_budget);
+
+    shared_ptr<const LadderTree> tree(const string& begin_word);
+    vector<string> ladder(const string& begin_word, const string& end_word);
+
+    size_t size() const;
+    size_t memory_used() const;
+    size_t hits() const;
+    size_t misses() const;
+
+private:
+    using Entry = pair<string, shared_ptr<const LadderTree>>;
+
+    const WordGraph& graph;
+    size_t budget;
+    mutable mutex lock;
+    list<Entry> recent;                                    // most recently used first
+    unordered_map<string, list<Entry>::iterator> entries;  // begin word -> its place in recent
+    size_t used = 0;
+    size_t hit_count = 0, miss_count = 0;
+};
+
 void load_words(set<string> & word_list, const string& file_name);
 void print_word_ladder(const vector<string>& ladder);
 void verify_word_ladder();
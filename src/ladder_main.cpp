@@ -0,0 +1,12 @@
+#include "ladder.h"
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        verify_word_ladder();
+        return 0;
+    }
+    set<string> word_list;
+    load_words(word_list, "words.txt");
+    print_word_ladder(generate_word_ladder(argv[1], argv[2], word_list));
+    return 0;
+}
@@ -0,0 +1,50 @@
+#include "search_trace.h"
+
+#include <sstream>
+
+SearchTrace::SearchTrace() : outer(current), origin(chrono::steady_clock::now()) {
+    current = this;
+}
+
+SearchTrace::~SearchTrace() {
+    current = outer;
+}
+
+double SearchTrace::now_us() const {
+    return chrono::duration<double, micro>(chrono::steady_clock::now() - origin).count();
+}
+
+// The counters as "name": value pairs, shared by both export formats.
+static void write_counters(ostream& out, const SearchCounters& c) {
+    out << "\"nodes_expanded\": " << c.nodes_expanded
+        << ", \"candidates_generated\": " << c.candidates_generated
+        << ", \"dictionary_probes\": " << c.dictionary_probes
+        << ", \"heap_pushes\": " << c.heap_pushes
+        << ", \"stale_pops\": " << c.stale_pops
+        << ", \"relaxations\": " << c.relaxations
+        << ", \"peak_queue\": " << c.peak_queue;
+}
+
+string SearchTrace::to_json() const {
+    ostringstream out;
+    out << "{\"counters\": {";
+    write_counters(out, counters);
+    out << "}, \"phases\": [";
+    for (size_t i = 0; i < phases.size(); i++)
+        out << (i ? ", " : "") << "{\"name\": \"" << phases[i].name << "\", \"start_us\": " << phases[i].start_us
+            << ", \"duration_us\": " << phases[i].duration_us << "}";
+    out << "]}";
+    return out.str();
+}
+
+string SearchTrace::to_chrome_trace() const {
+    ostringstream out;
+    out << "{\"traceEvents\": [";
+    for (const TracePhase& phase : phases)
+        out << "{\"name\": \"" << phase.name << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": 1, \"ts\": "
+            << phase.start_us << ", \"dur\": " << phase.duration_us << "}, ";
+    out << "{\"name\": \"counters\", \"ph\": \"C\", \"pid\": 1, \"tid\": 1, \"ts\": " << now_us() << ", \"args\": {";
+    write_counters(out, counters);
+    out << "}}]}";
+    return out.str();
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/*
+  Optional instrumentation for the ladder and Dijkstra searches. Configure with
+  -DSEARCH_TRACE=ON (which defines SEARCH_TRACE) to compile the TRACE_* hooks into the hot
+  paths; without it they expand to nothing, so the searches carry no extra work at all and a
+  SearchTrace simply stays empty.
+
+  While a SearchTrace is alive, every instrumented search on the same thread adds its work
+  to it. Traces nest: the innermost one collects, and the outer one resumes when it ends.
+*/
+#ifdef SEARCH_TRACE
+inline constexpr bool search_trace_enabled = true;
+#else
+inline constexpr bool search_trace_enabled = false;
+#endif
+
+struct SearchCounters {
+    long long nodes_expanded = 0;        // words or vertices whose neighbors were scanned
+    long long candidates_generated = 0;  // ladder: neighbor words considered
+    long long dictionary_probes = 0;     // ladder: lookups of a word in the dictionary
+    long long heap_pushes = 0;           // Dijkstra: queue insertions and decrease-keys
+    long long stale_pops = 0;            // Dijkstra: pops of already settled vertices
+    long long relaxations = 0;           // Dijkstra: edges examined from settled vertices
+    long long peak_queue = 0;            // largest queue or BFS frontier seen
+};
+
+struct TracePhase {
+    const char* name;
+    double start_us;      // since the SearchTrace was created
+    double duration_us;
+};
+
+class SearchTrace {
+public:
+    SearchTrace();
+    ~SearchTrace();
+    SearchTrace(const SearchTrace&) = delete;
+    SearchTrace& operator=(const SearchTrace&) = delete;
+
+    SearchCounters counters;
+    vector<TracePhase> phases;   // in order of completion
+
+    // {"counters": {...}, "phases": [{"name": ..., "start_us": ..., "duration_us": ...}]}
+    string to_json() const;
+    // Trace Event Format for chrome://tracing or Perfetto: one complete ("X") event per
+    // phase and a counter ("C") event with the totals.
+    string to_chrome_trace() const;
+
+    static SearchTrace* active() { return current; }
+    double now_us() const;
+
+private:
+    inline static thread_local SearchTrace* current = nullptr;
+    SearchTrace* outer;
+    chrono::steady_clock::time_point origin;
+};
+
+// Records the time from its construction to its destruction as one phase of the active trace.
+class TracePhaseScope {
+public:
+    explicit TracePhaseScope(const char* name) : trace(SearchTrace::active()), name(name) {
+        if (trace) start = trace->now_us();
+    }
+    ~TracePhaseScope() {
+        if (trace) trace->phases.push_back({name, start, trace->now_us() - start});
+    }
+    TracePhaseScope(const TracePhaseScope&) = delete;
+    TracePhaseScope& operator=(const TracePhaseScope&) = delete;
+
+private:
+    SearchTrace* trace;
+    const char* name;
+    double start = 0;
+};
+
+#ifdef SEARCH_TRACE
+#define TRACE_ADD(counter, n) \
+    do { if (SearchTrace* trace_ = SearchTrace::active()) trace_->counters.counter += (n); } while (0)
+#define TRACE_MAX(counter, value) \
+    do { \
+        if (SearchTrace* trace_ = SearchTrace::active()) \
+            trace_->counters.counter = max<long long>(trace_->counters.counter, (value)); \
+    } while (0)
+#define TRACE_PHASE_CONCAT(a, b) a##b
+#define TRACE_PHASE_NAME(line) TRACE_PHASE_CONCAT(trace_phase_, line)
+#define TRACE_PHASE(name) TracePhaseScope TRACE_PHASE_NAME(__LINE__)(name)
+#else
+#define TRACE_ADD(counter, n) ((void)0)
+#define TRACE_MAX(counter, value) ((void)0)
+#define TRACE_PHASE(name) ((void)0)
+#endif